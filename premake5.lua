@@ -19,7 +19,122 @@ project "cppserv"
     system "linux"
 
     links {
-    	"spdlog"
+    	"spdlog",
+        "ssl",
+        "crypto",
+        "z"
+	}
+
+    -- exports the symbols of the executable, so the sampling profiler can name its frames
+    linkoptions { "-rdynamic" }
+
+    includedirs {
+        "./lib/spdlog/include"
+    }
+
+    defines { "SPDLOG_COMPILED_LIB" }
+
+    filter { "configurations:debug" }
+        defines { "DEBUG" }
+        symbols "On"
+
+    filter { "configurations:release" }
+        defines { "NDEBUG" }
+        optimize "On"
+
+project "cppserv-logcat"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++20"
+    architecture "x86_64"
+    targetdir ("./bin/" .. outputDir .. "/%{prj.name}")
+	objdir ("./bin-int/" .. outputDir .. "/%{prj.name}")
+    files { "tools/logcat/**.cpp", "src/logger/AccessLogFormat.h" }
+    system "linux"
+
+    filter { "configurations:debug" }
+        defines { "DEBUG" }
+        symbols "On"
+
+    filter { "configurations:release" }
+        defines { "NDEBUG" }
+        optimize "On"
+
+project "cppserv-loadgen"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++20"
+    architecture "x86_64"
+    targetdir ("./bin/" .. outputDir .. "/%{prj.name}")
+	objdir ("./bin-int/" .. outputDir .. "/%{prj.name}")
+    files {
+        "tools/loadgen/**.cpp",
+        "src/capture/CaptureFormat.h",
+        "src/socket/Socket.cpp",
+        "src/diagnostics/Probes.cpp",
+        "src/logger/Logger.cpp",
+        "src/logger/BackgroundRotatingSink.cpp",
+        "src/diagnostics/InstrumentedMutex.cpp",
+        "src/metrics/Metrics.cpp",
+        "src/metrics/MetricsRegistry.cpp",
+        "src/metrics/TscClock.cpp"
+    }
+    system "linux"
+
+    links {
+    	"spdlog",
+        "z"
+	}
+
+    includedirs {
+        "./lib/spdlog/include"
+    }
+
+    defines { "SPDLOG_COMPILED_LIB" }
+
+    filter { "configurations:debug" }
+        defines { "DEBUG" }
+        symbols "On"
+
+    filter { "configurations:release" }
+        defines { "NDEBUG" }
+        optimize "On"
+
+project "cppserv-bench"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++20"
+    architecture "x86_64"
+    targetdir ("./bin/" .. outputDir .. "/%{prj.name}")
+	objdir ("./bin-int/" .. outputDir .. "/%{prj.name}")
+    files {
+        "tools/bench/**.cpp",
+        "src/http/httpparser.cpp",
+        "src/http/HttpPipeline.cpp",
+        "src/transport/LoopbackTransport.cpp",
+        "src/diagnostics/FlightRecorder.cpp",
+        "src/memory/RequestArena.cpp",
+        "src/memory/AllocationCounter.cpp",
+        "src/threadpool/Threadpool.cpp",
+        "src/socket/Socket.cpp",
+        "src/tls/TlsContext.cpp",
+        "src/tls/TlsConnection.cpp",
+        "src/diagnostics/Probes.cpp",
+        "src/logger/Logger.cpp",
+        "src/logger/BackgroundRotatingSink.cpp",
+        "src/diagnostics/InstrumentedMutex.cpp",
+        "src/metrics/Metrics.cpp",
+        "src/metrics/MetricsRegistry.cpp",
+        "src/metrics/HardwareCounters.cpp",
+        "src/metrics/TscClock.cpp"
+    }
+    system "linux"
+
+    links {
+    	"spdlog",
+        "ssl",
+        "crypto",
+        "z"
 	}
 
     includedirs {
@@ -34,4 +149,4 @@ project "cppserv"
 
     filter { "configurations:release" }
         defines { "NDEBUG" }
-        optimize "On"
\ No newline at end of file
+        optimize "On"
@@ -0,0 +1,56 @@
+#include "AdminRegistry.h"
+
+namespace cppserv {
+
+    std::map<std::string, AdminQueryHandler, std::less<> > AdminRegistry::s_Endpoints;
+
+    void AdminRegistry::Register(const std::string& path, AdminHandler handler) {
+        s_Endpoints[path] = [handler = std::move(handler)](std::string_view) {
+            return handler();
+        };
+    }
+
+    void AdminRegistry::Register(const std::string& path, AdminQueryHandler handler) {
+        s_Endpoints[path] = std::move(handler);
+    }
+
+    bool AdminRegistry::Handle(std::string_view path, std::string& body) {
+        std::string_view query;
+        size_t separator = path.find('?');
+        if (separator != std::string_view::npos) {
+            query = path.substr(separator + 1);
+            path = path.substr(0, separator);
+        }
+        auto it = s_Endpoints.find(path);
+        if (it == s_Endpoints.end()) {
+            return false;
+        }
+        body = it->second(query);
+        return true;
+    }
+
+    std::vector<std::string> AdminRegistry::GetPaths() {
+        std::vector<std::string> paths;
+        for (const auto& [path, handler] : s_Endpoints) {
+            paths.push_back(path);
+        }
+        return paths;
+    }
+
+    std::string_view AdminRegistry::GetQueryValue(std::string_view query, std::string_view name) {
+        while (!query.empty()) {
+            size_t end = query.find('&');
+            std::string_view parameter = query.substr(0, end);
+            size_t equals = parameter.find('=');
+            if (parameter.substr(0, equals) == name) {
+                return equals != std::string_view::npos ? parameter.substr(equals + 1) : std::string_view();
+            }
+            if (end == std::string_view::npos) {
+                break;
+            }
+            query.remove_prefix(end + 1);
+        }
+        return std::string_view();
+    }
+
+} // namespace cppserv
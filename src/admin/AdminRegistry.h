@@ -0,0 +1,85 @@
+#ifndef __ADMINREGISTRY_H__
+#define __ADMINREGISTRY_H__
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace cppserv {
+
+    /**
+     * \brief Produces the plain text body of an admin endpoint.
+     */
+    using AdminHandler = std::function<std::string()>;
+
+    /**
+     * \brief Produces the plain text body of an admin endpoint that takes parameters.
+     *
+     * The handler gets the query string of the request without the '?', e.g. `seconds=5&hz=99`.
+     */
+    using AdminQueryHandler = std::function<std::string(std::string_view query)>;
+
+    /**
+     * \brief Maps request paths to diagnostic endpoints that are served next to the regular responses.
+     *
+     * Endpoints are registered once at startup by the modules that own the data (flight recorder,
+     * metrics...); the request path looks them up by exact path. The table is not locked, so all
+     * endpoints must be registered before the server accepts connections. A query string is not part
+     * of the path, it is passed to the handlers that take one.
+     */
+    class AdminRegistry {
+    public:
+        /**
+         * \brief Registers an endpoint, replacing an earlier one with the same path.
+         *
+         * \param path The request path, e.g. `/admin/flight-recorder`.
+         * \param handler The handler that renders the body.
+         */
+        static void Register(const std::string& path, AdminHandler handler);
+
+        /**
+         * \brief Registers an endpoint that takes parameters, replacing an earlier one with the same path.
+         *
+         * \param path The request path without query string, e.g. `/admin/profile`.
+         * \param handler The handler that renders the body from the query string.
+         */
+        static void Register(const std::string& path, AdminQueryHandler handler);
+
+        /**
+         * \brief Renders the endpoint of a path.
+         *
+         * \param path The request path, optionally followed by a query string.
+         * \param body Receives the body of the endpoint.
+         * \return Returns true if an endpoint is registered for the path.
+         */
+        static bool Handle(std::string_view path, std::string& body);
+
+        /**
+         * \brief Returns true if no endpoint is registered, to skip the lookup on the request path.
+         */
+        static bool Empty() { return s_Endpoints.empty(); }
+
+        /**
+         * \brief Returns the paths of all registered endpoints.
+         */
+        static std::vector<std::string> GetPaths();
+
+        /**
+         * \brief Looks up a parameter of a query string.
+         *
+         * \param query The query string, e.g. `seconds=5&hz=99`.
+         * \param name The parameter name.
+         * \return Returns the raw value, or an empty view if the parameter is not present.
+         */
+        static std::string_view GetQueryValue(std::string_view query, std::string_view name);
+
+    private:
+        static std::map<std::string, AdminQueryHandler, std::less<> > s_Endpoints;
+
+    };
+
+} // namespace cppserv
+
+#endif // __ADMINREGISTRY_H__
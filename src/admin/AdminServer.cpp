@@ -0,0 +1,116 @@
+#include "AdminServer.h"
+
+#include <poll.h>
+#include <vector>
+
+#include "AdminRegistry.h"
+#include "../http/httpparser.h"
+#include "../http/httputil.h"
+#include "../logger/Logger.h"
+
+namespace cppserv {
+
+    static const std::string s_NotFound = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    static const std::string s_BadRequest = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+    /**
+     * \brief Size of the receive buffer, admin requests are a request line and a few headers.
+     */
+    constexpr size_t ADMIN_REQUEST_SIZE = 8192;
+
+    /**
+     * \brief Seconds the admin thread waits for a request before it closes the connection.
+     */
+    constexpr int ADMIN_READ_TIMEOUT = 5;
+
+    int AdminServer::Init(const AdminServerConfig& config) {
+        m_Listener = std::make_unique<Socket>(AF_INET, SOCK_STREAM, 0);
+        int reuseAddress = 1;
+        m_Listener->SocketSetOpt(SOL_SOCKET, SO_REUSEADDR, &reuseAddress);
+        if (m_Listener->Bind(config.host, config.port) != 0 || m_Listener->Listen(16) < 0) {
+            CPPSERV_ERROR("admin server error: cannot listen on {}:{}", config.host, config.port);
+            m_Listener->Close();
+            m_Listener.reset();
+            return -1;
+        }
+
+        m_Stop.store(false);
+        m_Thread = std::thread([this] {
+            Run();
+        });
+        CPPSERV_INFO("Serving admin endpoints on {}:{}", config.host, config.port);
+        return 0;
+    }
+
+    void AdminServer::Shutdown() {
+        m_Stop.store(true);
+        if (m_Thread.joinable()) {
+            m_Thread.join();
+        }
+        if (m_Listener) {
+            m_Listener->Close();
+            m_Listener.reset();
+        }
+    }
+
+    void AdminServer::Run() {
+        struct pollfd pfd;
+        pfd.fd = m_Listener->GetHandle();
+        pfd.events = POLLIN;
+        while (!m_Stop.load()) {
+            // wakes up regularly to notice Shutdown
+            pfd.revents = 0;
+            if (::poll(&pfd, 1, 200) < 1) {
+                continue;
+            }
+            struct sockaddr_storage peer;
+            socklen_t peerLen;
+            int handle = m_Listener->AcceptHandle(peer, peerLen, SOCK_CLOEXEC);
+            if (handle < 0) {
+                continue;
+            }
+            Serve(handle);
+        }
+    }
+
+    void AdminServer::Serve(int handle) {
+        Socket client(handle);
+        std::vector<char> buffer(ADMIN_REQUEST_SIZE);
+        size_t buffered = 0;
+        HttpRequest request;
+        int parsed = HTTP_PARSE_INCOMPLETE;
+        while (parsed == HTTP_PARSE_INCOMPLETE && buffered < buffer.size()) {
+            int received = client.SocketSafeRead(buffer.data() + buffered, buffer.size() - buffered, ADMIN_READ_TIMEOUT);
+            if (received <= 0) {
+                break;
+            }
+            buffered += (size_t)received;
+            parsed = HttpParser::Parse(std::string_view(buffer.data(), buffered), request, buffer.size());
+        }
+
+        if (parsed != HTTP_PARSE_INCOMPLETE) {
+            std::string body;
+            std::string response;
+            if (parsed < 0) {
+                response = s_BadRequest;
+            } else if (AdminRegistry::Handle(request.GetPath(), body)) {
+                response = BuildTextResponse(body);
+            } else {
+                response = s_NotFound;
+            }
+            size_t written = 0;
+            while (written < response.size()) {
+                int count = client.SocketWrite(response.data() + written, response.size() - written);
+                if (count < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (count <= 0) {
+                    break;
+                }
+                written += (size_t)count;
+            }
+        }
+        client.Close();
+    }
+
+} // namespace cppserv
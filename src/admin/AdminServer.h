@@ -0,0 +1,64 @@
+#ifndef __ADMINSERVER_H__
+#define __ADMINSERVER_H__
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "../core/cppservcore.h"
+#include "../socket/Socket.h"
+
+namespace cppserv {
+
+    struct AdminServerConfig {
+        // loopback by default, the endpoints are diagnostics and not meant for clients
+        std::string host = "127.0.0.1";
+        std::string port = "";
+    };
+
+    /**
+     * \brief Serves the AdminRegistry endpoints on a listener of their own.
+     *
+     * The admin port is kept apart from the HTTP listener, so clients cannot reach diagnostics and an
+     * expensive endpoint (a profile runs for seconds) never occupies a worker of the thread pool. A
+     * single thread accepts and answers one request at a time and closes every connection; a request
+     * that arrives during a profile waits for it.
+     */
+    class AdminServer {
+    public:
+        AdminServer() {}
+        ~AdminServer() { Shutdown(); }
+
+        AdminServer(const AdminServer&) = delete;
+        AdminServer& operator=(const AdminServer&) = delete;
+
+        /**
+         * \brief Binds the admin listener and starts its thread.
+         *
+         * All endpoints must be registered before, the registry is not locked.
+         *
+         * \param config The admin server configuration.
+         * \return Returns 0 on success, or a negative value indicating an error.
+         */
+        int Init(const AdminServerConfig& config);
+
+        /**
+         * \brief Stops the admin thread after the request it is serving and closes the listener.
+         */
+        void Shutdown();
+
+    private:
+        void Run();
+        void Serve(int handle);
+
+    private:
+        std::unique_ptr<Socket> m_Listener;
+        std::thread m_Thread;
+        std::atomic<bool> m_Stop = false;
+
+    };
+
+} // namespace cppserv
+
+#endif // __ADMINSERVER_H__
@@ -0,0 +1,46 @@
+#ifndef __CAPTUREFORMAT_H__
+#define __CAPTUREFORMAT_H__
+
+#include <stdint.h>
+
+namespace cppserv {
+
+    /**
+     * \brief On-disk layout of a traffic capture.
+     *
+     * A capture file starts with a CaptureFileHeader followed by records. Every record is a
+     * CaptureRecord followed by the raw request bytes, padded to 8 bytes. Records are in the order
+     * the requests were handed to the capture, which is close to but not strictly arrival order
+     * when several workers capture at once; readers sort by `arrivalNs` if they need it.
+     *
+     * All fields are little endian.
+     */
+
+    constexpr char CAPTURE_MAGIC[4] = { 'C', 'S', 'T', 'C' };
+    constexpr uint32_t CAPTURE_VERSION = 1;
+
+    struct CaptureFileHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t startNs;       // wall clock time the capture started, unix nanoseconds
+        uint64_t reserved;
+    };
+
+    struct CaptureRecord {
+        uint64_t arrivalNs;     // first byte of the request, nanoseconds since the capture started
+        uint64_t connectionId;  // unique per accepted connection
+        uint32_t slot;          // connection pool slot, reused by later connections
+        uint32_t length;        // bytes of the request that follow
+    };
+
+    static_assert(sizeof(CaptureFileHeader) == 24, "capture header layout changed");
+    static_assert(sizeof(CaptureRecord) == 24, "capture record layout changed");
+
+    constexpr uint32_t CapturePad(uint32_t size) {
+        return (size + 7u) & ~7u;
+    }
+
+} // namespace cppserv
+
+
+#endif // __CAPTUREFORMAT_H__
@@ -0,0 +1,125 @@
+#include "TrafficCapture.h"
+
+#include <mutex>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <strings.h>
+#include <time.h>
+
+#include "../logger/Logger.h"
+#include "../metrics/TscClock.h"
+#include "../diagnostics/InstrumentedMutex.h"
+
+namespace cppserv {
+
+    bool TrafficCapture::s_Enabled = false;
+
+    static InstrumentedMutex s_CaptureMutex("traffic_capture");
+    static FILE* s_File = nullptr;
+    static size_t s_Written = 0;
+    static size_t s_MaxBytes = 0;
+    static uint64_t s_Records = 0;
+    static uint64_t s_Dropped = 0;
+    static uint64_t s_StartTicks = 0;
+    static CaptureRedactor s_Redactor = TrafficCapture::RedactCredentials;
+
+    static const char* s_CredentialHeaders[] = { "authorization", "proxy-authorization", "cookie", "x-api-key" };
+
+    int TrafficCapture::Init(const TrafficCaptureConfig& config) {
+        s_File = fopen(config.path.c_str(), "wb");
+        if (s_File == nullptr) {
+            CPPSERV_ERROR("capture open error: {}: {}", config.path, strerror(errno));
+            return -1;
+        }
+        setvbuf(s_File, nullptr, _IOFBF, 1048576);
+
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        CaptureFileHeader header;
+        memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+        header.version = CAPTURE_VERSION;
+        header.startNs = (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+        header.reserved = 0;
+        fwrite(&header, sizeof(header), 1, s_File);
+
+        s_Written = sizeof(header);
+        s_MaxBytes = config.maxBytes;
+        s_StartTicks = TscClock::Now();
+        s_Enabled = true;
+        CPPSERV_INFO("Capturing requests to {}", config.path);
+        return 0;
+    }
+
+    void TrafficCapture::Shutdown() {
+        std::lock_guard<InstrumentedMutex> lock(s_CaptureMutex);
+        if (s_File == nullptr) {
+            return;
+        }
+        s_Enabled = false;
+        fclose(s_File);
+        s_File = nullptr;
+        CPPSERV_INFO("Captured {} requests ({} bytes), {} not captured after the size limit", s_Records, s_Written, s_Dropped);
+    }
+
+    void TrafficCapture::SetRedactor(CaptureRedactor redactor) {
+        s_Redactor = std::move(redactor);
+    }
+
+    void TrafficCapture::Record(uint64_t connectionId, uint32_t slot, uint64_t arrivalTicks, std::string_view request) {
+        static thread_local std::string t_Request;
+        t_Request.assign(request);
+        if (s_Redactor) {
+            s_Redactor(t_Request);
+        }
+
+        CaptureRecord record;
+        // ticks taken before the capture started count as its start
+        record.arrivalNs = TscClock::Between(s_StartTicks, arrivalTicks);
+        record.connectionId = connectionId;
+        record.slot = slot;
+        record.length = (uint32_t)t_Request.size();
+        static const char padding[8] = {};
+        size_t size = sizeof(record) + CapturePad(record.length);
+
+        std::lock_guard<InstrumentedMutex> lock(s_CaptureMutex);
+        if (s_File == nullptr) {
+            return;
+        }
+        if (s_Written + size > s_MaxBytes) {
+            s_Dropped++;
+            return;
+        }
+        fwrite(&record, sizeof(record), 1, s_File);
+        fwrite(t_Request.data(), 1, t_Request.size(), s_File);
+        fwrite(padding, 1, CapturePad(record.length) - record.length, s_File);
+        s_Written += size;
+        s_Records++;
+    }
+
+    void TrafficCapture::RedactCredentials(std::string& request) {
+        size_t headEnd = request.find("\r\n\r\n");
+        size_t line = request.find("\r\n");
+        while (line != std::string::npos && line < headEnd) {
+            size_t start = line + 2;
+            size_t end = std::min(request.find("\r\n", start), request.size());
+            size_t colon = request.find(':', start);
+            if (colon != std::string::npos && colon < end) {
+                for (const char* name : s_CredentialHeaders) {
+                    size_t length = strlen(name);
+                    if (colon - start == length && strncasecmp(request.data() + start, name, length) == 0) {
+                        size_t value = colon + 1;
+                        while (value < end && request[value] == ' ') {
+                            value++;
+                        }
+                        // same length, so replaying keeps the header sizes of the original traffic
+                        std::fill(request.begin() + (std::ptrdiff_t)value, request.begin() + (std::ptrdiff_t)end, 'x');
+                        break;
+                    }
+                }
+            }
+            line = end < request.size() ? end : std::string::npos;
+        }
+    }
+
+} // namespace cppserv
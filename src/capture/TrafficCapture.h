@@ -0,0 +1,79 @@
+#ifndef __TRAFFICCAPTURE_H__
+#define __TRAFFICCAPTURE_H__
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <stdint.h>
+
+#include "CaptureFormat.h"
+
+namespace cppserv {
+
+    struct TrafficCaptureConfig {
+        std::string path = "capture.bin";
+        size_t maxBytes = 1024 * 1048576;
+    };
+
+    /**
+     * \brief Rewrites a request before it is written to the capture, e.g. to mask credentials.
+     */
+    using CaptureRedactor = std::function<void(std::string& request)>;
+
+    /**
+     * \brief Records the raw bytes and arrival times of incoming requests for replay.
+     *
+     * Every request is passed through the redactor, copied into a buffered file under a lock and
+     * replayed later by `cppserv-loadgen --replay`. Capturing stops once the file reaches its size
+     * limit. The capture is meant for recording a representative window of traffic, not to stay on.
+     */
+    class TrafficCapture {
+    public:
+        /**
+         * \brief Creates the capture file and starts capturing.
+         *
+         * \param config The capture configuration.
+         * \return Returns 0 on success, or a negative value indicating an error.
+         */
+        static int Init(const TrafficCaptureConfig& config);
+
+        /**
+         * \brief Flushes and closes the capture file. No request may be recorded afterwards.
+         */
+        static void Shutdown();
+
+        static bool IsEnabled() { return s_Enabled; }
+
+        /**
+         * \brief Sets the redactor applied to every request, must be called before `Init`.
+         *
+         * \param redactor The redactor, an empty function captures requests unchanged.
+         */
+        static void SetRedactor(CaptureRedactor redactor);
+
+        /**
+         * \brief Appends a request to the capture.
+         *
+         * \param connectionId The unique id of the connection.
+         * \param slot The connection pool slot of the connection.
+         * \param arrivalTicks The TscClock reading when the first byte of the request was received.
+         * \param request The raw bytes of the request.
+         */
+        static void Record(uint64_t connectionId, uint32_t slot, uint64_t arrivalTicks, std::string_view request);
+
+        /**
+         * \brief The default redactor: overwrites the values of credential headers (Authorization,
+         * Proxy-Authorization, Cookie, X-Api-Key) with 'x', keeping their length.
+         *
+         * \param request The request to redact in place.
+         */
+        static void RedactCredentials(std::string& request);
+
+    private:
+        static bool s_Enabled;
+    };
+
+} // namespace cppserv
+
+
+#endif // __TRAFFICCAPTURE_H__
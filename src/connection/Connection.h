@@ -0,0 +1,127 @@
+#ifndef __CONNECTION_H__
+#define __CONNECTION_H__
+
+#include <atomic>
+#include <stdint.h>
+
+#include "../core/cppservcore.h"
+#include "../socket/Socket.h"
+#include "../memory/BufferPool.h"
+#include "../metrics/RequestTimeline.h"
+
+namespace cppserv {
+
+    /**
+     * \brief A generation-tagged reference to a pooled connection.
+     *
+     * The generation of a slot is bumped every time the connection is released, so a handle that
+     * outlives its connection no longer matches and `ConnectionPool::Get` returns nullptr instead of
+     * a recycled connection. Handles are two plain integers and can be copied freely.
+     */
+    struct ConnectionHandle {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+    };
+
+    class ConnectionPool;
+
+    /**
+     * \brief The per-connection state of the server.
+     *
+     * Connections are never allocated individually; they live in the slabs of a ConnectionPool and are
+     * recycled. The socket, the peer address and the parser progress are stored inline; the receive
+     * buffer is borrowed from the BufferPool while the connection is reading.
+     */
+    class Connection {
+    public:
+        Connection() : m_Socket(-1), m_PeerLen(0), m_Index(0), m_Generation(0), m_NextFree(UINT32_MAX),
+            m_Id(0), m_Buffer(nullptr), m_BufferSize(0), m_Buffered(0), m_SampleHandle(-1), m_Samplers(0) {}
+        ~Connection() {}
+
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+
+        Socket& GetSocket() { return m_Socket; }
+        const struct sockaddr_storage& GetPeer() const { return m_Peer; }
+        socklen_t GetPeerLength() const { return m_PeerLen; }
+
+        /**
+         * \brief Returns a process wide unique id of the connection (not reused when the slot is recycled).
+         */
+        uint64_t GetId() const { return m_Id; }
+
+        ConnectionHandle GetHandle() const {
+            return ConnectionHandle{ m_Index, m_Generation.load(std::memory_order_relaxed) };
+        }
+
+        /**
+         * \brief Borrows a receive buffer from the BufferPool unless the connection already has one.
+         *
+         * \return Returns false if the pool is exhausted; the connection should then be parked.
+         */
+        bool AcquireBuffer() {
+            if (m_Buffer == nullptr) {
+                m_Buffer = BufferPool::Get().Acquire();
+                m_BufferSize = m_Buffer != nullptr ? BufferPool::Get().GetBufferSize() : 0;
+            }
+            return m_Buffer != nullptr;
+        }
+
+        /**
+         * \brief Returns the receive buffer to the BufferPool.
+         */
+        void ReleaseBuffer() {
+            BufferPool::Get().Release(m_Buffer);
+            m_Buffer = nullptr;
+            m_BufferSize = 0;
+            m_Buffered = 0;
+        }
+
+        /**
+         * \brief Returns the receive buffer of the connection.
+         */
+        char* GetBuffer() { return m_Buffer; }
+
+        /**
+         * \brief Returns the number of bytes received into the buffer so far.
+         */
+        size_t GetBuffered() const { return m_Buffered; }
+
+        /**
+         * \brief Returns the number of free bytes left in the buffer.
+         */
+        size_t GetBufferSpace() const { return m_BufferSize - m_Buffered; }
+
+        /**
+         * \brief Marks `count` more bytes of the buffer as filled.
+         */
+        void Commit(size_t count) { m_Buffered += count; }
+
+        /**
+         * \brief Returns the stage timestamps of the request on this connection, reset on acquire.
+         */
+        RequestTimeline& GetTimeline() { return m_Timeline; }
+
+    private:
+        friend class ConnectionPool;
+
+        Socket m_Socket;
+        struct sockaddr_storage m_Peer;
+        socklen_t m_PeerLen;
+        uint32_t m_Index;
+        std::atomic<uint32_t> m_Generation;
+        uint32_t m_NextFree;
+        uint64_t m_Id;
+        char* m_Buffer;
+        size_t m_BufferSize;
+        size_t m_Buffered;
+        RequestTimeline m_Timeline;
+        // the socket handle while the connection is in use, -1 otherwise; see `ConnectionPool::Sample`
+        std::atomic<int> m_SampleHandle;
+        std::atomic<uint32_t> m_Samplers;
+    };
+
+} // namespace cppserv
+
+
+#endif // __CONNECTION_H__
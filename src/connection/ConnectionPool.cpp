@@ -0,0 +1,113 @@
+#include "ConnectionPool.h"
+
+#include <thread>
+
+#include "../logger/Logger.h"
+
+namespace cppserv {
+
+    int ConnectionPool::Init(size_t maxConnections) {
+        size_t limit = CONNECTION_POOL_SLAB_SIZE * CONNECTION_POOL_MAX_SLABS;
+        if (maxConnections == 0 || maxConnections > limit) {
+            CPPSERV_ERROR("connection pool error: capacity must be between 1 and {}", limit);
+            return -1;
+        }
+        m_MaxConnections = maxConnections;
+        CPPSERV_TRACE("Initializing connection pool for {} connections", maxConnections);
+        return 0;
+    }
+
+    Connection* ConnectionPool::Acquire(int handle, const struct sockaddr_storage& peer, socklen_t peerLen) {
+        Connection* connection = nullptr;
+        {
+            std::unique_lock<InstrumentedMutex> lock(m_Mutex);
+            if (m_FreeHead != UINT32_MAX) {
+                connection = Slot(m_FreeHead);
+                m_FreeHead = connection->m_NextFree;
+            } else {
+                uint32_t allocated = m_Allocated.load(std::memory_order_relaxed);
+                if (allocated >= m_MaxConnections) {
+                    return nullptr;
+                }
+                size_t slab = allocated / CONNECTION_POOL_SLAB_SIZE;
+                if (!m_Slabs[slab]) {
+                    m_Slabs[slab].reset(new Connection[CONNECTION_POOL_SLAB_SIZE]);
+                }
+                connection = Slot(allocated);
+                connection->m_Index = allocated;
+                m_Allocated.store(allocated + 1, std::memory_order_release);
+            }
+            connection->m_Id = m_NextId++;
+            m_Active.store(m_Active.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        connection->m_Socket = Socket(handle);
+        connection->m_Timeline = RequestTimeline();
+        memcpy(&connection->m_Peer, &peer, peerLen);
+        connection->m_PeerLen = peerLen;
+        connection->m_NextFree = UINT32_MAX;
+        connection->m_Buffered = 0;
+        // publishes the socket, id and peer to Sample
+        connection->m_SampleHandle.store(handle);
+        return connection;
+    }
+
+    void ConnectionPool::Release(Connection* connection) {
+        connection->ReleaseBuffer();
+        // a sampler either sees -1 or has announced itself before, in which case the socket must stay open until it is done
+        connection->m_SampleHandle.store(-1);
+        while (connection->m_Samplers.load() != 0) {
+            std::this_thread::yield();
+        }
+        connection->m_Socket.Close();
+        connection->m_Socket = Socket(-1);
+        // invalidate outstanding handles before the slot can be handed out again
+        connection->m_Generation.store(connection->m_Generation.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+        std::unique_lock<InstrumentedMutex> lock(m_Mutex);
+        connection->m_NextFree = m_FreeHead;
+        m_FreeHead = connection->m_Index;
+        m_Active.store(m_Active.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    }
+
+    void ConnectionPool::Park(ConnectionHandle handle) {
+        std::unique_lock<InstrumentedMutex> lock(m_ParkedMutex);
+        m_Parked.push_back(handle);
+        m_ParkedCount.store(m_Parked.size(), std::memory_order_relaxed);
+    }
+
+    bool ConnectionPool::Unpark(ConnectionHandle& handle) {
+        std::unique_lock<InstrumentedMutex> lock(m_ParkedMutex);
+        if (m_Parked.empty()) {
+            return false;
+        }
+        handle = m_Parked.front();
+        m_Parked.pop_front();
+        m_ParkedCount.store(m_Parked.size(), std::memory_order_relaxed);
+        return true;
+    }
+
+    void ConnectionPool::Sample(const std::function<void(Connection&)>& visitor) {
+        uint32_t allocated = m_Allocated.load(std::memory_order_acquire);
+        for (uint32_t index = 0; index < allocated; index++) {
+            Connection* connection = Slot(index);
+            connection->m_Samplers.fetch_add(1);
+            if (connection->m_SampleHandle.load() >= 0) {
+                visitor(*connection);
+            }
+            connection->m_Samplers.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    Connection* ConnectionPool::Get(ConnectionHandle handle) {
+        if (handle.index >= m_Allocated.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        Connection* connection = Slot(handle.index);
+        if (connection->m_Generation.load(std::memory_order_acquire) != handle.generation) {
+            return nullptr;
+        }
+        return connection;
+    }
+
+} // namespace cppserv
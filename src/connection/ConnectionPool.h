@@ -0,0 +1,128 @@
+#ifndef __CONNECTIONPOOL_H__
+#define __CONNECTIONPOOL_H__
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "../core/cppservcore.h"
+#include "Connection.h"
+#include "../diagnostics/InstrumentedMutex.h"
+
+namespace cppserv {
+
+    constexpr size_t CONNECTION_POOL_SLAB_SIZE = 256;
+    constexpr size_t CONNECTION_POOL_MAX_SLABS = 1024;
+
+    /**
+     * \brief A slab allocator with a free list for Connection objects.
+     *
+     * Slabs of `CONNECTION_POOL_SLAB_SIZE` connections are allocated on demand and never freed while the
+     * pool is alive, so memory grows with peak concurrency and connection churn does not reach the
+     * allocator. Acquire and Release take a short mutex; resolving a handle with `Get` is a bounds check
+     * and a generation compare.
+     */
+    class ConnectionPool {
+    public:
+        ConnectionPool() {}
+        ~ConnectionPool() {}
+
+        ConnectionPool(const ConnectionPool&) = delete;
+        ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+        /**
+         * \brief Initializes the pool.
+         *
+         * \param maxConnections The maximum number of concurrent connections.
+         * \return Returns 0 on success, or a negative value indicating an error.
+         */
+        int Init(size_t maxConnections);
+
+        /**
+         * \brief Takes a connection from the pool for an accepted socket.
+         *
+         * \param handle The handle of the accepted socket; the connection takes ownership of it.
+         * \param peer The address of the peer.
+         * \param peerLen The length of the peer address.
+         * \return Returns the connection, or nullptr if the pool is exhausted.
+         */
+        Connection* Acquire(int handle, const struct sockaddr_storage& peer, socklen_t peerLen);
+
+        /**
+         * \brief Closes the socket of a connection and returns the connection to the pool.
+         *
+         * All outstanding handles of the connection become stale.
+         *
+         * \param connection The connection to release.
+         */
+        void Release(Connection* connection);
+
+        /**
+         * \brief Resolves a handle.
+         *
+         * \param handle The handle to resolve.
+         * \return Returns the connection, or nullptr if the handle is stale or invalid.
+         */
+        Connection* Get(ConnectionHandle handle);
+
+        /**
+         * \brief Parks a connection that cannot make progress until an I/O buffer becomes available.
+         *
+         * \param handle The handle of the connection.
+         */
+        void Park(ConnectionHandle handle);
+
+        /**
+         * \brief Takes the longest parked connection off the parked list.
+         *
+         * \param handle Reference that receives the handle of the connection.
+         * \return Returns false if no connection is parked.
+         */
+        bool Unpark(ConnectionHandle& handle);
+
+        /**
+         * \brief Calls `visitor` for every connection that is in use, from any thread.
+         *
+         * The socket of a visited connection stays open until the visitor returns: Release waits for
+         * running visitors before it closes the socket, so the visitor must be short (a `getsockopt`)
+         * and must not release connections itself. Only the socket, the id and the peer address may be
+         * read; the rest of the connection belongs to the thread serving it.
+         *
+         * \param visitor The function to call.
+         */
+        void Sample(const std::function<void(Connection&)>& visitor);
+
+        /**
+         * \brief Returns the number of parked connections.
+         */
+        size_t GetParked() const { return m_ParkedCount.load(std::memory_order_relaxed); }
+
+        /**
+         * \brief Returns the number of connections currently in use.
+         */
+        size_t GetActive() const { return m_Active.load(std::memory_order_relaxed); }
+
+    private:
+        Connection* Slot(uint32_t index) {
+            return &m_Slabs[index / CONNECTION_POOL_SLAB_SIZE][index % CONNECTION_POOL_SLAB_SIZE];
+        }
+
+    private:
+        InstrumentedMutex m_Mutex{ "connection_pool" };
+        std::unique_ptr<Connection[]> m_Slabs[CONNECTION_POOL_MAX_SLABS];
+        std::atomic<uint32_t> m_Allocated = 0;
+        uint32_t m_FreeHead = UINT32_MAX;
+        size_t m_MaxConnections = 0;
+        uint64_t m_NextId = 1;
+        std::atomic<size_t> m_Active = 0;
+        InstrumentedMutex m_ParkedMutex{ "connection_pool_parked" };
+        std::deque<ConnectionHandle> m_Parked;
+        std::atomic<size_t> m_ParkedCount = 0;
+    };
+
+} // namespace cppserv
+
+
+#endif // __CONNECTIONPOOL_H__
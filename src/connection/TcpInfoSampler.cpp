@@ -0,0 +1,150 @@
+#include "TcpInfoSampler.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <cstdio>
+
+#include "../logger/Logger.h"
+#include "../metrics/MetricsRegistry.h"
+
+namespace cppserv {
+
+    static const char* s_StateNames[] = {
+        "?", "ESTABLISHED", "SYN_SENT", "SYN_RECV", "FIN_WAIT1", "FIN_WAIT2", "TIME_WAIT",
+        "CLOSE", "CLOSE_WAIT", "LAST_ACK", "LISTEN", "CLOSING"
+    };
+
+    static std::string FormatPeer(const struct sockaddr_storage& peer) {
+        char host[INET6_ADDRSTRLEN] = "?";
+        unsigned port = 0;
+        if (peer.ss_family == AF_INET) {
+            const struct sockaddr_in* address = (const struct sockaddr_in*)&peer;
+            inet_ntop(AF_INET, &address->sin_addr, host, sizeof(host));
+            port = ntohs(address->sin_port);
+        } else if (peer.ss_family == AF_INET6) {
+            const struct sockaddr_in6* address = (const struct sockaddr_in6*)&peer;
+            inet_ntop(AF_INET6, &address->sin6_addr, host, sizeof(host));
+            port = ntohs(address->sin6_port);
+        }
+        return std::string(host) + ":" + std::to_string(port);
+    }
+
+    int TcpInfoSampler::Init(ConnectionPool& pool, unsigned intervalMs) {
+        if (intervalMs == 0) {
+            CPPSERV_ERROR("tcp info sampler error: the interval must be at least 1ms");
+            return -1;
+        }
+        m_Pool = &pool;
+        m_IntervalMs = intervalMs;
+
+        MetricsRegistry& registry = MetricsRegistry::Get();
+        m_Rtt = &registry.AddHistogram("cppserv_tcp_rtt_seconds",
+            "Smoothed round trip time of the open connections, sampled from TCP_INFO.");
+        m_Retransmits = &registry.AddHistogram("cppserv_tcp_retransmits",
+            "Segments retransmitted so far on the open connections, sampled from TCP_INFO.", "", HistogramUnit::COUNT);
+        m_CongestionWindow = &registry.AddHistogram("cppserv_tcp_cwnd_segments",
+            "Congestion window of the open connections in segments, sampled from TCP_INFO.", "", HistogramUnit::COUNT);
+        m_Unacked = &registry.AddHistogram("cppserv_tcp_unacked_segments",
+            "Segments sent but not yet acknowledged on the open connections, sampled from TCP_INFO.", "", HistogramUnit::COUNT);
+
+        m_Stop = false;
+        m_Thread = std::thread([this] {
+            Run();
+        });
+        CPPSERV_TRACE("Sampling TCP_INFO of open connections every {}ms", intervalMs);
+        return 0;
+    }
+
+    void TcpInfoSampler::Shutdown() {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Stop = true;
+        }
+        m_CV.notify_all();
+        if (m_Thread.joinable()) {
+            m_Thread.join();
+        }
+    }
+
+    /**
+     * \brief Bytes of `struct tcp_info` the kernel has to fill in, up to the last field that is exported.
+     */
+    static constexpr socklen_t TCP_INFO_MIN_LENGTH = std::max({
+        offsetof(struct tcp_info, tcpi_state) + sizeof(tcp_info::tcpi_state),
+        offsetof(struct tcp_info, tcpi_unacked) + sizeof(tcp_info::tcpi_unacked),
+        offsetof(struct tcp_info, tcpi_lost) + sizeof(tcp_info::tcpi_lost),
+        offsetof(struct tcp_info, tcpi_snd_mss) + sizeof(tcp_info::tcpi_snd_mss),
+        offsetof(struct tcp_info, tcpi_rtt) + sizeof(tcp_info::tcpi_rtt),
+        offsetof(struct tcp_info, tcpi_rttvar) + sizeof(tcp_info::tcpi_rttvar),
+        offsetof(struct tcp_info, tcpi_snd_cwnd) + sizeof(tcp_info::tcpi_snd_cwnd),
+        offsetof(struct tcp_info, tcpi_total_retrans) + sizeof(tcp_info::tcpi_total_retrans)
+    });
+
+    int TcpInfoSampler::Read(Socket& socket, struct tcp_info& info) {
+        memset(&info, 0, sizeof(info));
+        socklen_t length = sizeof(info);
+        if (socket.SocketGetOpt(IPPROTO_TCP, TCP_INFO, &info, length) < 0) {
+            return -1;
+        }
+        if (length < TCP_INFO_MIN_LENGTH) {
+            CPPSERV_ERROR("tcp_info error: kernel returned {} of {} bytes", length, TCP_INFO_MIN_LENGTH);
+            return -1;
+        }
+        return 0;
+    }
+
+    void TcpInfoSampler::Run() {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        while (!m_Stop) {
+            m_CV.wait_for(lock, std::chrono::milliseconds(m_IntervalMs), [this] { return m_Stop; });
+            if (m_Stop) {
+                break;
+            }
+            m_Pool->Sample([this](Connection& connection) {
+                struct tcp_info info;
+                if (Read(connection.GetSocket(), info) < 0) {
+                    return;
+                }
+                m_Rtt->Record((uint64_t)info.tcpi_rtt * 1000);
+                m_Retransmits->Record(info.tcpi_total_retrans);
+                m_CongestionWindow->Record(info.tcpi_snd_cwnd);
+                m_Unacked->Record(info.tcpi_unacked);
+            });
+        }
+    }
+
+    std::string TcpInfoSampler::Report(ConnectionPool& pool) {
+        struct Line {
+            uint64_t id;
+            struct sockaddr_storage peer;
+            struct tcp_info info;
+        };
+        // only copy while visiting, the socket of a visited connection cannot be closed until we return
+        std::vector<Line> lines;
+        lines.reserve(pool.GetActive() + 16);
+        pool.Sample([&lines](Connection& connection) {
+            Line& line = lines.emplace_back();
+            line.id = connection.GetId();
+            memcpy(&line.peer, &connection.GetPeer(), sizeof(line.peer));
+            if (Read(connection.GetSocket(), line.info) < 0) {
+                lines.pop_back();
+            }
+        });
+
+        std::string text = std::to_string(lines.size()) + " connections\n";
+        char buffer[512];
+        for (const Line& line : lines) {
+            const struct tcp_info& info = line.info;
+            snprintf(buffer, sizeof(buffer),
+                "conn %llu %s %s: rtt %.3fms rttvar %.3fms retrans %u cwnd %u unacked %u mss %u lost %u\n",
+                (unsigned long long)line.id, FormatPeer(line.peer).c_str(),
+                info.tcpi_state < sizeof(s_StateNames) / sizeof(s_StateNames[0]) ? s_StateNames[info.tcpi_state] : "?",
+                (double)info.tcpi_rtt / 1e3, (double)info.tcpi_rttvar / 1e3, info.tcpi_total_retrans,
+                info.tcpi_snd_cwnd, info.tcpi_unacked, info.tcpi_snd_mss, info.tcpi_lost);
+            text += buffer;
+        }
+        return text;
+    }
+
+} // namespace cppserv
@@ -0,0 +1,81 @@
+#ifndef __TCPINFOSAMPLER_H__
+#define __TCPINFOSAMPLER_H__
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <netinet/tcp.h>
+
+#include "../core/cppservcore.h"
+#include "ConnectionPool.h"
+#include "../metrics/Metrics.h"
+
+namespace cppserv {
+
+    /**
+     * \brief Samples the kernel's view (`TCP_INFO`) of the open connections of a ConnectionPool.
+     *
+     * A background thread reads `TCP_INFO` of every connection in use once per interval and records
+     * the smoothed RTT, the retransmitted segments, the congestion window and the unacknowledged
+     * segments into histograms. Each tick records one value per open connection, so long-lived
+     * connections weigh more than short ones. `Report` reads the same values on demand for the
+     * `/admin/connections` endpoint.
+     */
+    class TcpInfoSampler {
+    public:
+        TcpInfoSampler() {}
+        ~TcpInfoSampler() { Shutdown(); }
+
+        TcpInfoSampler(const TcpInfoSampler&) = delete;
+        TcpInfoSampler& operator=(const TcpInfoSampler&) = delete;
+
+        /**
+         * \brief Registers the histograms and starts the sampling thread.
+         *
+         * \param pool The pool whose connections are sampled, must outlive the sampler.
+         * \param intervalMs The time between two samples of all connections.
+         * \return Returns 0 on success, or a negative value indicating an error.
+         */
+        int Init(ConnectionPool& pool, unsigned intervalMs);
+
+        /**
+         * \brief Stops the sampling thread.
+         */
+        void Shutdown();
+
+        /**
+         * \brief Reads `TCP_INFO` of a socket.
+         *
+         * \param socket The TCP socket.
+         * \param info Receives the info, fields an older kernel does not report are zero.
+         * \return Returns 0 on success, or a negative value indicating an error or a kernel that does not
+         *         report every exported field.
+         */
+        static int Read(Socket& socket, struct tcp_info& info);
+
+        /**
+         * \brief Renders the `/admin/connections` endpoint: one line per open connection of the pool.
+         */
+        static std::string Report(ConnectionPool& pool);
+
+    private:
+        void Run();
+
+    private:
+        ConnectionPool* m_Pool = nullptr;
+        unsigned m_IntervalMs = 0;
+        Histogram* m_Rtt = nullptr;
+        Histogram* m_Retransmits = nullptr;
+        Histogram* m_CongestionWindow = nullptr;
+        Histogram* m_Unacked = nullptr;
+        std::thread m_Thread;
+        std::mutex m_Mutex;
+        std::condition_variable m_CV;
+        bool m_Stop = false;
+
+    };
+
+} // namespace cppserv
+
+#endif // __TCPINFOSAMPLER_H__
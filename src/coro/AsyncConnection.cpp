@@ -0,0 +1,82 @@
+#include "AsyncConnection.h"
+
+namespace cppserv {
+
+    AsyncConnection::AsyncConnection(EventLoop& loop, Socket socket) : m_Loop(&loop), m_Socket(socket), m_Open(true) {
+        m_Socket.SetNonBlocking();
+    }
+
+    AsyncConnection::AsyncConnection(AsyncConnection&& other) noexcept
+        : m_Loop(other.m_Loop), m_Socket(other.m_Socket), m_Open(std::exchange(other.m_Open, false)) {
+
+    }
+
+    AsyncConnection::~AsyncConnection() {
+        Close();
+    }
+
+    Task<int> AsyncConnection::Read(char* buf, size_t len, EventLoop::Clock::time_point deadline) {
+        while (true) {
+            int status = m_Socket.SocketRead(buf, len);
+            if (status >= 0) {
+                co_return status;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                co_return status;
+            }
+            if (deadline == EventLoop::Clock::time_point::max()) {
+                co_await m_Loop->WaitReadable(m_Socket.GetHandle());
+            } else if (!co_await m_Loop->WaitReadable(m_Socket.GetHandle(), deadline)) {
+                errno = ETIMEDOUT;
+                co_return -1;
+            }
+        }
+    }
+
+    Task<int> AsyncConnection::Write(const char* buf, size_t len) {
+        size_t written = 0;
+        while (written < len) {
+            int status = m_Socket.SocketWrite(buf + written, len - written);
+            if (status >= 0) {
+                written += (size_t)status;
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                co_return status;
+            }
+            co_await m_Loop->WaitWritable(m_Socket.GetHandle());
+        }
+        co_return (int)written;
+    }
+
+    void AsyncConnection::Close() {
+        if (!m_Open) {
+            return;
+        }
+        m_Open = false;
+        m_Loop->Forget(m_Socket.GetHandle());
+        m_Socket.Close();
+    }
+
+    AsyncListener::AsyncListener(EventLoop& loop, Socket& listener) : m_Loop(loop), m_Listener(listener) {
+        m_Listener.SetNonBlocking();
+    }
+
+    AsyncListener::~AsyncListener() {
+        m_Loop.Forget(m_Listener.GetHandle());
+    }
+
+    Task<int> AsyncListener::Accept(struct sockaddr_storage& peer, socklen_t& peerLen) {
+        while (true) {
+            int handle = m_Listener.AcceptHandle(peer, peerLen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (handle >= 0) {
+                co_return handle;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                co_return handle;
+            }
+            co_await m_Loop.WaitReadable(m_Listener.GetHandle());
+        }
+    }
+
+} // namespace cppserv
@@ -0,0 +1,105 @@
+#ifndef __ASYNCCONNECTION_H__
+#define __ASYNCCONNECTION_H__
+
+#include <string>
+
+#include "../core/cppservcore.h"
+#include "../socket/Socket.h"
+#include "EventLoop.h"
+#include "Task.h"
+
+namespace cppserv {
+
+    /**
+     * \brief A non-blocking connection whose operations suspend the calling coroutine instead of a thread.
+     *
+     * \code
+     * Task<void> Serve(AsyncConnection conn) {
+     *     char request[4096];
+     *     int received = co_await conn.Read(request, sizeof(request));
+     *     std::string_view response = "HTTP/1.1 204 No Content\r\n\r\n";
+     *     co_await conn.Write(response.data(), response.size());
+     *     conn.Close();
+     * }
+     * \endcode
+     */
+    class AsyncConnection {
+    public:
+        /**
+         * \brief Takes ownership of a connected socket and switches it to non-blocking mode.
+         *
+         * \param loop The loop the connection is driven by.
+         * \param socket The connected socket.
+         */
+        AsyncConnection(EventLoop& loop, Socket socket);
+
+        AsyncConnection(AsyncConnection&& other) noexcept;
+        AsyncConnection(const AsyncConnection&) = delete;
+        AsyncConnection& operator=(const AsyncConnection&) = delete;
+        ~AsyncConnection();
+
+        /**
+         * \brief Reads the next chunk of data, suspending until data is available.
+         *
+         * \param buf Pointer to the buffer where the received data will be stored.
+         * \param len The size of the buffer.
+         * \param deadline The time after which the read gives up, by default it waits forever.
+         * \return Returns the number of bytes received, 0 if the peer closed the connection, or a negative value
+         *         indicating an error (`errno` is ETIMEDOUT if the deadline passed).
+         */
+        Task<int> Read(char* buf, size_t len, EventLoop::Clock::time_point deadline = EventLoop::Clock::time_point::max());
+
+        /**
+         * \brief Writes the whole buffer, suspending whenever the send buffer is full.
+         *
+         * The data is not copied, it must stay valid until the returned task completes.
+         *
+         * \param buf Pointer to the data to write.
+         * \param len The number of bytes to write.
+         * \return Returns the number of bytes written, or a negative value indicating an error.
+         */
+        Task<int> Write(const char* buf, size_t len);
+
+        /**
+         * \brief Removes the connection from the loop and closes the socket.
+         */
+        void Close();
+
+        Socket& GetSocket() { return m_Socket; }
+
+    private:
+        EventLoop* m_Loop;
+        Socket m_Socket;
+        bool m_Open;
+    };
+
+    class AsyncListener {
+    public:
+        /**
+         * \brief Wraps a listening socket and switches it to non-blocking mode.
+         *
+         * \param loop The loop the listener is driven by.
+         * \param listener The bound and listening socket.
+         */
+        AsyncListener(EventLoop& loop, Socket& listener);
+        ~AsyncListener();
+
+        /**
+         * \brief Accepts the next connection, suspending until one is pending.
+         *
+         * \param peer Receives the address of the peer.
+         * \param peerLen Receives the length of the peer address.
+         * \return Returns the handle of the accepted (non-blocking) connection, or a negative value indicating an
+         *         error other than no pending connection (e.g. EMFILE), which the caller should back off from.
+         */
+        Task<int> Accept(struct sockaddr_storage& peer, socklen_t& peerLen);
+
+    private:
+        EventLoop& m_Loop;
+        Socket& m_Listener;
+    };
+
+} // namespace cppserv
+
+
+#endif // __ASYNCCONNECTION_H__
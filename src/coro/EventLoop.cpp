@@ -0,0 +1,223 @@
+#include "EventLoop.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <string.h>
+
+#include "../logger/Logger.h"
+
+namespace cppserv {
+
+    static constexpr int EVENT_LOOP_MAX_EVENTS = 128;
+
+    static thread_local EventLoop* s_CurrentLoop = nullptr;
+
+    namespace {
+
+        /**
+         * \brief Fire-and-forget coroutine that owns a spawned task until it completes.
+         */
+        struct DetachedTask {
+            struct promise_type {
+                DetachedTask get_return_object() noexcept { return {}; }
+                std::suspend_never initial_suspend() noexcept { return {}; }
+                std::suspend_never final_suspend() noexcept { return {}; }
+                void return_void() noexcept {}
+                void unhandled_exception() noexcept {}
+
+                static void* operator new(size_t size) { return FramePool::Allocate(size); }
+                static void operator delete(void* frame) { FramePool::Deallocate(frame); }
+            };
+        };
+
+        DetachedTask RunDetached(Task<void> task) {
+            try {
+                co_await task;
+            } catch (const std::exception& e) {
+                CPPSERV_ERROR("unhandled exception in task: {}", e.what());
+            }
+        }
+
+    } // namespace
+
+    EventLoop::~EventLoop() {
+        if (m_Epoll >= 0) {
+            ::close(m_Epoll);
+        }
+        if (m_WakeFd >= 0) {
+            ::close(m_WakeFd);
+        }
+    }
+
+    int EventLoop::Init() {
+        m_Epoll = epoll_create1(EPOLL_CLOEXEC);
+        if (m_Epoll < 0) {
+            CPPSERV_ERROR("epoll_create error: {}", strerror(errno));
+            return -1;
+        }
+        m_WakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_WakeFd < 0) {
+            CPPSERV_ERROR("eventfd error: {}", strerror(errno));
+            return -1;
+        }
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = m_WakeFd;
+        if (epoll_ctl(m_Epoll, EPOLL_CTL_ADD, m_WakeFd, &event) < 0) {
+            CPPSERV_ERROR("epoll_ctl error: {}", strerror(errno));
+            return -1;
+        }
+        return 0;
+    }
+
+    EventLoop* EventLoop::Current() {
+        return s_CurrentLoop;
+    }
+
+    void EventLoop::Run() {
+        s_CurrentLoop = this;
+        struct epoll_event events[EVENT_LOOP_MAX_EVENTS];
+
+        while (!m_Stop.load(std::memory_order_acquire)) {
+            int timeout = -1;
+            if (!m_Timers.empty()) {
+                auto wait = std::chrono::ceil<std::chrono::milliseconds>(m_Timers.top().deadline - Clock::now());
+                timeout = wait.count() > 0 ? (int)wait.count() : 0;
+            }
+
+            int count = epoll_wait(m_Epoll, events, EVENT_LOOP_MAX_EVENTS, timeout);
+            if (count < 0 && errno != EINTR) {
+                CPPSERV_ERROR("epoll_wait error: {}", strerror(errno));
+                break;
+            }
+
+            for (int i = 0; i < count; i++) {
+                int fd = events[i].data.fd;
+                if (fd == m_WakeFd) {
+                    uint64_t value;
+                    while (::read(m_WakeFd, &value, sizeof(value)) > 0) {}
+                    continue;
+                }
+                if ((size_t)fd >= m_Waiters.size()) {
+                    continue;
+                }
+                uint32_t mask = events[i].events;
+                bool failed = (mask & (EPOLLERR | EPOLLHUP)) != 0;
+                if ((failed || (mask & (EPOLLIN | EPOLLRDHUP))) && m_Waiters[fd].reader) {
+                    m_Waiters[fd].readerTimer = 0;
+                    std::exchange(m_Waiters[fd].reader, nullptr).resume();
+                }
+                // the reader may have closed and forgotten the descriptor
+                if ((failed || (mask & EPOLLOUT)) && m_Waiters[fd].writer) {
+                    std::exchange(m_Waiters[fd].writer, nullptr).resume();
+                }
+            }
+
+            RunTimers();
+            RunPosted();
+        }
+
+        s_CurrentLoop = nullptr;
+    }
+
+    void EventLoop::Stop() {
+        m_Stop.store(true, std::memory_order_release);
+        uint64_t one = 1;
+        if (::write(m_WakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            CPPSERV_ERROR("eventfd write error: {}", strerror(errno));
+        }
+    }
+
+    void EventLoop::Spawn(Task<void> task) {
+        RunDetached(std::move(task));
+    }
+
+    void EventLoop::Post(std::coroutine_handle<> handle) {
+        {
+            std::unique_lock<std::mutex> lock(m_PostMutex);
+            m_Posted.push_back(handle);
+        }
+        uint64_t one = 1;
+        if (::write(m_WakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            CPPSERV_ERROR("eventfd write error: {}", strerror(errno));
+        }
+    }
+
+    void EventLoop::Forget(int fd) {
+        if (fd < 0 || (size_t)fd >= m_Waiters.size() || !m_Waiters[fd].registered) {
+            return;
+        }
+        epoll_ctl(m_Epoll, EPOLL_CTL_DEL, fd, NULL);
+        m_Waiters[fd] = Waiters();
+    }
+
+    void EventLoop::Watch(int fd, bool write, std::coroutine_handle<> handle) {
+        if ((size_t)fd >= m_Waiters.size()) {
+            m_Waiters.resize((size_t)fd + 1);
+        }
+        Waiters& waiters = m_Waiters[fd];
+        if (!waiters.registered) {
+            // edge triggered: callers always try the operation first and only wait on EAGAIN
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            event.data.fd = fd;
+            if (epoll_ctl(m_Epoll, EPOLL_CTL_ADD, fd, &event) < 0) {
+                CPPSERV_ERROR("epoll_ctl error: {}", strerror(errno));
+                // resume on the next iteration, the retried operation reports the error
+                AddTimer(Clock::now(), handle);
+                return;
+            }
+            waiters.registered = true;
+        }
+        if (write) {
+            waiters.writer = handle;
+        } else {
+            waiters.reader = handle;
+        }
+    }
+
+    void EventLoop::WatchUntil(int fd, Clock::time_point deadline, std::coroutine_handle<> handle) {
+        Watch(fd, false, handle);
+        // Watch resumes on the next iteration instead if the descriptor cannot be registered
+        if ((size_t)fd < m_Waiters.size() && m_Waiters[fd].reader == handle) {
+            m_Waiters[fd].readerTimer = m_TimerSequence;
+            m_Timers.push(Timer{ deadline, m_TimerSequence++, handle, fd });
+        }
+    }
+
+    void EventLoop::AddTimer(Clock::time_point deadline, std::coroutine_handle<> handle) {
+        m_Timers.push(Timer{ deadline, m_TimerSequence++, handle });
+    }
+
+    void EventLoop::RunTimers() {
+        Clock::time_point now = Clock::now();
+        while (!m_Timers.empty() && m_Timers.top().deadline <= now) {
+            Timer timer = m_Timers.top();
+            m_Timers.pop();
+            if (timer.fd >= 0) {
+                // the descriptor became ready or was forgotten before the deadline
+                if ((size_t)timer.fd >= m_Waiters.size() || m_Waiters[timer.fd].readerTimer != timer.sequence) {
+                    continue;
+                }
+                m_Waiters[timer.fd].reader = nullptr;
+                m_Waiters[timer.fd].readerTimer = 0;
+            }
+            timer.handle.resume();
+        }
+    }
+
+    void EventLoop::RunPosted() {
+        {
+            std::unique_lock<std::mutex> lock(m_PostMutex);
+            m_Running.swap(m_Posted);
+        }
+        for (auto handle : m_Running) {
+            handle.resume();
+        }
+        m_Running.clear();
+    }
+
+} // namespace cppserv
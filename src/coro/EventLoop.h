@@ -0,0 +1,171 @@
+#ifndef __EVENTLOOP_H__
+#define __EVENTLOOP_H__
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include "../core/cppservcore.h"
+#include "Task.h"
+
+namespace cppserv {
+
+    class EventLoop {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        EventLoop() {}
+        ~EventLoop();
+
+        EventLoop(const EventLoop&) = delete;
+        EventLoop& operator=(const EventLoop&) = delete;
+
+        /**
+         * \brief Creates the epoll instance and the wakeup eventfd of the loop.
+         *
+         * \return Returns 0 on success, or a negative value indicating an error.
+         */
+        int Init();
+
+        /**
+         * \brief Runs the loop on the calling thread until `Stop` is called.
+         *
+         * All coroutines spawned on this loop are resumed on this thread only.
+         */
+        void Run();
+
+        /**
+         * \brief Asks the loop to return from `Run`. Can be called from any thread.
+         */
+        void Stop();
+
+        /**
+         * \brief Starts a top level task. The task frame is released when it finishes.
+         *
+         * The task runs until its first suspension on the calling thread, so this function must only be
+         * called from the loop thread (e.g. from another task) or before `Run`.
+         *
+         * \param task The task to run on this loop.
+         */
+        void Spawn(Task<void> task);
+
+        /**
+         * \brief Schedules a suspended coroutine to be resumed on the loop thread. Can be called from any thread.
+         *
+         * \param handle The coroutine to resume.
+         */
+        void Post(std::coroutine_handle<> handle);
+
+        /**
+         * \brief Removes a file descriptor from the loop. Must be called before the descriptor is closed.
+         *
+         * \param fd The file descriptor.
+         */
+        void Forget(int fd);
+
+        /**
+         * \brief Returns the loop that runs on the calling thread, or nullptr.
+         */
+        static EventLoop* Current();
+
+        struct IoAwaitable {
+            EventLoop& m_Loop;
+            int m_Fd;
+            bool m_Write;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { m_Loop.Watch(m_Fd, m_Write, handle); }
+            void await_resume() const noexcept {}
+        };
+
+        struct TimedIoAwaitable {
+            EventLoop& m_Loop;
+            int m_Fd;
+            Clock::time_point m_Deadline;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { m_Loop.WatchUntil(m_Fd, m_Deadline, handle); }
+            bool await_resume() const noexcept { return Clock::now() < m_Deadline; }
+        };
+
+        struct SleepAwaitable {
+            EventLoop& m_Loop;
+            Clock::time_point m_Deadline;
+
+            bool await_ready() const noexcept { return m_Deadline <= Clock::now(); }
+            void await_suspend(std::coroutine_handle<> handle) { m_Loop.AddTimer(m_Deadline, handle); }
+            void await_resume() const noexcept {}
+        };
+
+        /**
+         * \brief Suspends the calling coroutine until `fd` is readable (or has an error / hangup).
+         */
+        IoAwaitable WaitReadable(int fd) { return IoAwaitable{ *this, fd, false }; }
+
+        /**
+         * \brief Suspends the calling coroutine until `fd` is readable (or has an error / hangup) or the deadline passed.
+         *
+         * Yields false if the deadline passed first. The timer of a wait that ended early stays queued, and
+         * is skipped, until its deadline.
+         */
+        TimedIoAwaitable WaitReadable(int fd, Clock::time_point deadline) { return TimedIoAwaitable{ *this, fd, deadline }; }
+
+        /**
+         * \brief Suspends the calling coroutine until `fd` is writable (or has an error / hangup).
+         */
+        IoAwaitable WaitWritable(int fd) { return IoAwaitable{ *this, fd, true }; }
+
+        /**
+         * \brief Suspends the calling coroutine for the specified duration.
+         */
+        template<typename Rep, typename Period>
+        SleepAwaitable SleepFor(std::chrono::duration<Rep, Period> duration) {
+            return SleepAwaitable{ *this, Clock::now() + std::chrono::duration_cast<Clock::duration>(duration) };
+        }
+
+    private:
+        struct Waiters {
+            std::coroutine_handle<> reader;
+            std::coroutine_handle<> writer;
+            // sequence of the timer bounding the reader's wait, 0 if none
+            uint64_t readerTimer = 0;
+            bool registered = false;
+        };
+
+        struct Timer {
+            Clock::time_point deadline;
+            uint64_t sequence;
+            std::coroutine_handle<> handle;
+            // the descriptor of a timed wait, the timer is stale unless it still bounds that wait
+            int fd = -1;
+
+            bool operator>(const Timer& other) const {
+                return deadline != other.deadline ? deadline > other.deadline : sequence > other.sequence;
+            }
+        };
+
+        void Watch(int fd, bool write, std::coroutine_handle<> handle);
+        void WatchUntil(int fd, Clock::time_point deadline, std::coroutine_handle<> handle);
+        void AddTimer(Clock::time_point deadline, std::coroutine_handle<> handle);
+        void RunTimers();
+        void RunPosted();
+
+    private:
+        int m_Epoll = -1;
+        int m_WakeFd = -1;
+        std::atomic<bool> m_Stop = false;
+        std::vector<Waiters> m_Waiters;
+        std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer> > m_Timers;
+        uint64_t m_TimerSequence = 1;
+        std::mutex m_PostMutex;
+        std::vector<std::coroutine_handle<> > m_Posted;
+        std::vector<std::coroutine_handle<> > m_Running;
+    };
+
+} // namespace cppserv
+
+
+#endif // __EVENTLOOP_H__
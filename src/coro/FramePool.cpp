@@ -0,0 +1,86 @@
+#include "FramePool.h"
+
+#include <cstddef>
+#include <new>
+#include <stdint.h>
+
+namespace cppserv {
+
+    static constexpr size_t FRAME_POOL_CLASSES = FramePool::FRAME_POOL_MAX_FRAME / FramePool::FRAME_POOL_GRANULARITY;
+    static constexpr uint32_t FRAME_POOL_UNPOOLED = UINT32_MAX;
+
+    /**
+     * \brief Prefix stored in front of every frame, keeps the frame aligned for any type.
+     */
+    struct alignas(std::max_align_t) FrameHeader {
+        uint32_t sizeClass;
+    };
+
+    struct FreeFrame {
+        FreeFrame* next;
+    };
+
+    struct FrameCache {
+        FreeFrame* heads[FRAME_POOL_CLASSES] = {};
+        size_t counts[FRAME_POOL_CLASSES] = {};
+        size_t heapAllocations = 0;
+
+        ~FrameCache() {
+            for (size_t i = 0; i < FRAME_POOL_CLASSES; i++) {
+                while (heads[i] != nullptr) {
+                    FreeFrame* frame = heads[i];
+                    heads[i] = frame->next;
+                    ::operator delete(frame);
+                }
+            }
+        }
+    };
+
+    static thread_local FrameCache s_FrameCache;
+
+    void* FramePool::Allocate(size_t size) {
+        size_t total = size + sizeof(FrameHeader);
+        FrameHeader* header;
+
+        if (total > FRAME_POOL_MAX_FRAME) {
+            header = (FrameHeader*)::operator new(total);
+            header->sizeClass = FRAME_POOL_UNPOOLED;
+            s_FrameCache.heapAllocations++;
+            return header + 1;
+        }
+
+        size_t sizeClass = (total - 1) / FRAME_POOL_GRANULARITY;
+        FreeFrame* frame = s_FrameCache.heads[sizeClass];
+        if (frame != nullptr) {
+            s_FrameCache.heads[sizeClass] = frame->next;
+            s_FrameCache.counts[sizeClass]--;
+            header = (FrameHeader*)frame;
+        } else {
+            header = (FrameHeader*)::operator new((sizeClass + 1) * FRAME_POOL_GRANULARITY);
+            s_FrameCache.heapAllocations++;
+        }
+        header->sizeClass = (uint32_t)sizeClass;
+        return header + 1;
+    }
+
+    void FramePool::Deallocate(void* frame) {
+        if (frame == nullptr) {
+            return;
+        }
+        FrameHeader* header = (FrameHeader*)frame - 1;
+        uint32_t sizeClass = header->sizeClass;
+        if (sizeClass == FRAME_POOL_UNPOOLED || s_FrameCache.counts[sizeClass] >= FRAME_POOL_MAX_CACHED) {
+            ::operator delete(header);
+            return;
+        }
+        FreeFrame* free = (FreeFrame*)header;
+        free->next = s_FrameCache.heads[sizeClass];
+        s_FrameCache.heads[sizeClass] = free;
+        s_FrameCache.counts[sizeClass]++;
+    }
+
+    size_t FramePool::GetHeapAllocations() {
+        return s_FrameCache.heapAllocations;
+    }
+
+} // namespace cppserv
@@ -0,0 +1,47 @@
+#ifndef __FRAMEPOOL_H__
+#define __FRAMEPOOL_H__
+
+#include <stddef.h>
+
+namespace cppserv {
+
+    /**
+     * \brief A per-thread pooled allocator for coroutine frames.
+     *
+     * Frames are rounded up to size classes of `FRAME_POOL_GRANULARITY` bytes and recycled through
+     * thread local free lists, so suspending and finishing handlers does not hit the global heap once
+     * a thread has warmed up. Frames larger than `FRAME_POOL_MAX_FRAME` bytes bypass the pool. A frame
+     * may be released on a different thread than the one that allocated it, it then simply joins the
+     * free list of the releasing thread.
+     */
+    class FramePool {
+    public:
+        static constexpr size_t FRAME_POOL_GRANULARITY = 128;
+        static constexpr size_t FRAME_POOL_MAX_FRAME = 4096;
+        static constexpr size_t FRAME_POOL_MAX_CACHED = 256;
+
+        /**
+         * \brief Allocates a coroutine frame.
+         *
+         * \param size The size of the frame in bytes.
+         * \return Returns a pointer to the frame.
+         */
+        static void* Allocate(size_t size);
+
+        /**
+         * \brief Releases a frame that was allocated with `Allocate`.
+         *
+         * \param frame Pointer to the frame.
+         */
+        static void Deallocate(void* frame);
+
+        /**
+         * \brief Returns the number of frames the calling thread had to take from the heap.
+         */
+        static size_t GetHeapAllocations();
+    };
+
+} // namespace cppserv
+
+
+#endif // __FRAMEPOOL_H__
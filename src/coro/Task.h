@@ -0,0 +1,149 @@
+#ifndef __TASK_H__
+#define __TASK_H__
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+#include "FramePool.h"
+
+namespace cppserv {
+
+    template<typename T>
+    class Task;
+
+    namespace detail {
+
+        struct TaskPromiseBase {
+            struct FinalAwaiter {
+                bool await_ready() noexcept { return false; }
+
+                template<typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+                    return handle.promise().m_Continuation;
+                }
+
+                void await_resume() noexcept {}
+            };
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            FinalAwaiter final_suspend() noexcept { return {}; }
+            void unhandled_exception() { m_Exception = std::current_exception(); }
+
+            static void* operator new(size_t size) { return FramePool::Allocate(size); }
+            static void operator delete(void* frame) { FramePool::Deallocate(frame); }
+
+            std::coroutine_handle<> m_Continuation = std::noop_coroutine();
+            std::exception_ptr m_Exception;
+        };
+
+        template<typename T>
+        struct TaskPromise : TaskPromiseBase {
+            Task<T> get_return_object() noexcept;
+
+            template<typename U>
+            void return_value(U&& value) { m_Value.emplace(std::forward<U>(value)); }
+
+            T Result() {
+                if (m_Exception) {
+                    std::rethrow_exception(m_Exception);
+                }
+                return std::move(*m_Value);
+            }
+
+            std::optional<T> m_Value;
+        };
+
+        template<>
+        struct TaskPromise<void> : TaskPromiseBase {
+            Task<void> get_return_object() noexcept;
+
+            void return_void() noexcept {}
+
+            void Result() {
+                if (m_Exception) {
+                    std::rethrow_exception(m_Exception);
+                }
+            }
+        };
+
+    } // namespace detail
+
+    /**
+     * \brief A lazily started coroutine that produces a value of type T.
+     *
+     * The coroutine starts running when it is awaited and resumes its awaiter when it finishes
+     * (symmetric transfer, so long chains of tasks do not grow the stack). Frames are allocated from
+     * the per-thread FramePool. Top level tasks are started with `EventLoop::Spawn`.
+     */
+    template<typename T = void>
+    class Task {
+    public:
+        using promise_type = detail::TaskPromise<T>;
+
+        Task() noexcept : m_Handle(nullptr) {}
+        explicit Task(std::coroutine_handle<promise_type> handle) noexcept : m_Handle(handle) {}
+        Task(Task&& other) noexcept : m_Handle(std::exchange(other.m_Handle, nullptr)) {}
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                if (m_Handle) {
+                    m_Handle.destroy();
+                }
+                m_Handle = std::exchange(other.m_Handle, nullptr);
+            }
+            return *this;
+        }
+
+        ~Task() {
+            if (m_Handle) {
+                m_Handle.destroy();
+            }
+        }
+
+        auto operator co_await() && noexcept {
+            struct Awaiter {
+                std::coroutine_handle<promise_type> m_Handle;
+
+                bool await_ready() noexcept { return !m_Handle || m_Handle.done(); }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept {
+                    m_Handle.promise().m_Continuation = continuation;
+                    return m_Handle;
+                }
+
+                T await_resume() { return m_Handle.promise().Result(); }
+            };
+            return Awaiter{ m_Handle };
+        }
+
+        auto operator co_await() & noexcept {
+            return std::move(*this).operator co_await();
+        }
+
+        bool IsDone() const { return !m_Handle || m_Handle.done(); }
+
+    private:
+        std::coroutine_handle<promise_type> m_Handle;
+    };
+
+    namespace detail {
+
+        template<typename T>
+        inline Task<T> TaskPromise<T>::get_return_object() noexcept {
+            return Task<T>{ std::coroutine_handle<TaskPromise<T> >::from_promise(*this) };
+        }
+
+        inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+            return Task<void>{ std::coroutine_handle<TaskPromise<void> >::from_promise(*this) };
+        }
+
+    } // namespace detail
+
+} // namespace cppserv
+
+
+#endif // __TASK_H__
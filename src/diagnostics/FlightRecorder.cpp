@@ -0,0 +1,177 @@
+#include "FlightRecorder.h"
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace cppserv {
+
+    thread_local FlightRing* FlightRecorder::t_Ring = nullptr;
+
+    static std::atomic<FlightRing*> s_Rings[FLIGHT_RECORDER_MAX_RINGS];
+    static std::atomic<size_t> s_RingCount = 0;
+    static std::atomic<bool> s_Dumping = false;
+
+    static const char* s_StageNames[] = { "ACCEPT", "TLS_HANDSHAKE", "READ", "PARSED", "RESPONSE", "PARKED", "CLOSE" };
+
+    /**
+     * \brief Formats into a fixed buffer without allocating, so it can be used from a signal handler.
+     */
+    class DumpWriter {
+    public:
+        DumpWriter(int fd, std::string* text) : m_Fd(fd), m_Text(text), m_Used(0) {}
+        ~DumpWriter() { Flush(); }
+
+        DumpWriter& operator<<(const char* value) {
+            while (*value != '\0') {
+                Put(*value++);
+            }
+            return *this;
+        }
+
+        DumpWriter& operator<<(uint64_t value) {
+            char digits[20];
+            int count = 0;
+            do {
+                digits[count++] = (char)('0' + value % 10);
+                value /= 10;
+            } while (value != 0);
+            while (count > 0) {
+                Put(digits[--count]);
+            }
+            return *this;
+        }
+
+        DumpWriter& Hex(uint32_t value) {
+            static const char* hex = "0123456789abcdef";
+            for (int shift = 28; shift >= 0; shift -= 4) {
+                Put(hex[(value >> shift) & 0xf]);
+            }
+            return *this;
+        }
+
+        void Flush() {
+            if (m_Text != nullptr) {
+                m_Text->append(m_Buffer, m_Used);
+            } else {
+                size_t written = 0;
+                while (written < m_Used) {
+                    ssize_t result = write(m_Fd, m_Buffer + written, m_Used - written);
+                    if (result <= 0) {
+                        break;
+                    }
+                    written += (size_t)result;
+                }
+            }
+            m_Used = 0;
+        }
+
+    private:
+        void Put(char c) {
+            if (m_Used == sizeof(m_Buffer)) {
+                Flush();
+            }
+            m_Buffer[m_Used++] = c;
+        }
+
+    private:
+        int m_Fd;
+        std::string* m_Text;
+        size_t m_Used;
+        char m_Buffer[4096];
+
+    };
+
+    static void DumpRings(DumpWriter& out) {
+        uint64_t now = TscClock::Now();
+
+        size_t count = std::min(s_RingCount.load(std::memory_order_acquire), FLIGHT_RECORDER_MAX_RINGS);
+        out << "flight recorder: " << (uint64_t)count << " workers\n";
+        for (size_t i = 0; i < count; i++) {
+            FlightRing* ring = s_Rings[i].load(std::memory_order_acquire);
+            if (ring == nullptr) {
+                continue;
+            }
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            uint64_t first = head > FLIGHT_RECORDER_CAPACITY ? head - FLIGHT_RECORDER_CAPACITY : 0;
+            out << "worker " << (uint64_t)i << " (tid " << (uint64_t)ring->tid << "), " << head << " events\n";
+
+            for (uint64_t sequence = first; sequence < head; sequence++) {
+                const FlightRecord& record = ring->records[sequence & (FLIGHT_RECORDER_CAPACITY - 1)];
+                // overwritten while we were reading
+                if (record.sequence != sequence) {
+                    continue;
+                }
+                out << "  " << TscClock::Between(record.ticks, now) / 1000 << "us ago";
+                uint8_t stage = (uint8_t)record.stage;
+                out << " conn=" << record.connectionId << " "
+                    << (stage < sizeof(s_StageNames) / sizeof(s_StageNames[0]) ? s_StageNames[stage] : "?");
+                if (record.method != (uint8_t)HttpMethod::NOT_IMPLEMENTED) {
+                    out << " " << HttpMethodToString((HttpMethod)record.method);
+                }
+                if (record.pathHash != 0) {
+                    out << " path=";
+                    out.Hex(record.pathHash);
+                }
+                out << " value=" << (uint64_t)record.value << "\n";
+            }
+        }
+    }
+
+    static void HandleFatalSignal(int signal) {
+        if (!s_Dumping.exchange(true)) {
+            DumpWriter out(STDERR_FILENO, nullptr);
+            out << "fatal signal " << (uint64_t)signal << ", ";
+            DumpRings(out);
+        }
+        // the handler was reset by SA_RESETHAND, this terminates with the original signal
+        raise(signal);
+    }
+
+    void FlightRecorder::Init() {
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = HandleFatalSignal;
+        action.sa_flags = SA_RESETHAND | SA_NODEFER;
+        sigemptyset(&action.sa_mask);
+        for (int signal : { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT }) {
+            sigaction(signal, &action, nullptr);
+        }
+    }
+
+    void FlightRecorder::Dump(int fd) {
+        DumpWriter out(fd, nullptr);
+        DumpRings(out);
+    }
+
+    std::string FlightRecorder::DumpText() {
+        std::string text;
+        {
+            DumpWriter out(-1, &text);
+            DumpRings(out);
+        }
+        return text;
+    }
+
+    FlightRing* FlightRecorder::Register() {
+        static thread_local bool t_Registered = false;
+        if (t_Registered) {
+            // the thread did not get a ring, it is not recorded
+            return nullptr;
+        }
+        t_Registered = true;
+
+        size_t index = s_RingCount.fetch_add(1);
+        if (index >= FLIGHT_RECORDER_MAX_RINGS) {
+            return nullptr;
+        }
+        // rings live until the process exits so a dump never reads freed memory
+        FlightRing* ring = new FlightRing();
+        ring->tid = (int)syscall(SYS_gettid);
+        s_Rings[index].store(ring, std::memory_order_release);
+        t_Ring = ring;
+        return ring;
+    }
+
+} // namespace cppserv
@@ -0,0 +1,133 @@
+#ifndef __FLIGHTRECORDER_H__
+#define __FLIGHTRECORDER_H__
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include "../http/httputil.h"
+#include "../metrics/TscClock.h"
+
+namespace cppserv {
+
+    /**
+     * \brief Number of records every worker keeps, must be a power of two.
+     */
+    constexpr size_t FLIGHT_RECORDER_CAPACITY = 1024;
+
+    /**
+     * \brief Maximum number of threads that can record, further threads are not recorded.
+     */
+    constexpr size_t FLIGHT_RECORDER_MAX_RINGS = 256;
+
+    enum class FlightStage : uint8_t {
+        ACCEPT = 0,
+        TLS_HANDSHAKE,
+        READ,
+        PARSED,
+        RESPONSE,
+        PARKED,
+        CLOSE
+    };
+
+    /**
+     * \brief One event of a worker, 32 bytes.
+     */
+    struct FlightRecord {
+        uint64_t ticks;
+        uint64_t connectionId;
+        uint64_t sequence;
+        uint32_t pathHash;
+        FlightStage stage;
+        uint8_t method;
+        uint16_t value;
+    };
+    static_assert(sizeof(FlightRecord) == 32, "flight records must stay 32 bytes");
+
+    /**
+     * \brief The ring of one worker. Only the owning thread writes, readers tolerate torn records.
+     */
+    struct alignas(64) FlightRing {
+        std::atomic<uint64_t> head = 0;
+        int tid = 0;
+        FlightRecord records[FLIGHT_RECORDER_CAPACITY];
+    };
+
+    /**
+     * \brief An always-on in-memory record of what every worker did most recently.
+     *
+     * Each thread appends records to its own ring without locks or atomics other than a release store
+     * of its head; a record costs a TscClock reading and a 32 byte store. The rings are dumped as text
+     * on fatal signals (async-signal-safe, straight to stderr) and on demand, e.g. from an admin
+     * endpoint to see what a hanging worker was last doing.
+     */
+    class FlightRecorder {
+    public:
+        /**
+         * \brief Installs the fatal signal handlers that dump all rings before the process dies.
+         *
+         * TscClock must be calibrated before, the dump converts ticks with its rate.
+         */
+        static void Init();
+
+        /**
+         * \brief Appends an event to the ring of the calling thread.
+         *
+         * \param connectionId The connection the event belongs to.
+         * \param stage The stage of the request.
+         * \param method The request method, NOT_IMPLEMENTED while it is not known.
+         * \param pathHash The hash of the request path, see `HashPath`.
+         * \param value A stage specific value: bytes read, response status...
+         */
+        static void Record(uint64_t connectionId, FlightStage stage, HttpMethod method = HttpMethod::NOT_IMPLEMENTED,
+            uint32_t pathHash = 0, uint16_t value = 0) {
+            FlightRing* ring = t_Ring != nullptr ? t_Ring : Register();
+            if (ring == nullptr) {
+                return;
+            }
+            uint64_t head = ring->head.load(std::memory_order_relaxed);
+            FlightRecord& record = ring->records[head & (FLIGHT_RECORDER_CAPACITY - 1)];
+            record.ticks = TscClock::Now();
+            record.connectionId = connectionId;
+            record.sequence = head;
+            record.pathHash = pathHash;
+            record.stage = stage;
+            record.method = (uint8_t)method;
+            record.value = value;
+            ring->head.store(head + 1, std::memory_order_release);
+        }
+
+        /**
+         * \brief Returns the FNV-1a hash of a path, as stored in the records.
+         */
+        static uint32_t HashPath(std::string_view path) {
+            uint32_t hash = 2166136261u;
+            for (char c : path) {
+                hash = (hash ^ (uint8_t)c) * 16777619u;
+            }
+            return hash;
+        }
+
+        /**
+         * \brief Writes all rings, oldest record first, as text. Async-signal-safe.
+         *
+         * \param fd The file descriptor to write to.
+         */
+        static void Dump(int fd);
+
+        /**
+         * \brief Returns all rings as text.
+         */
+        static std::string DumpText();
+
+    private:
+        static FlightRing* Register();
+
+    private:
+        static thread_local FlightRing* t_Ring;
+
+    };
+
+} // namespace cppserv
+
+#endif // __FLIGHTRECORDER_H__
@@ -0,0 +1,74 @@
+#include "InstrumentedMutex.h"
+
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+
+#include "../metrics/MetricsRegistry.h"
+
+namespace cppserv {
+
+    /**
+     * \brief All lock names. Only touched when a mutex is constructed and on report, never on lock.
+     */
+    struct LockTable {
+        std::mutex mutex;
+        std::deque<LockStats> locks;
+    };
+
+    static LockTable& GetLockTable() {
+        static LockTable s_Table;
+        return s_Table;
+    }
+
+    LockStats& InstrumentedMutex::Stats(const char* name) {
+        LockTable& table = GetLockTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        for (LockStats& stats : table.locks) {
+            if (stats.name == name) {
+                return stats;
+            }
+        }
+
+        MetricsRegistry& registry = MetricsRegistry::Get();
+        std::string label = std::string("lock=\"") + name + "\"";
+        LockStats& stats = table.locks.emplace_back();
+        stats.name = name;
+        stats.contended = &registry.AddCounter("cppserv_lock_contended_total", "Acquisitions that had to wait for the lock.", label);
+        stats.wait = &registry.AddHistogram("cppserv_lock_wait_seconds", "Time contended acquisitions waited for the lock.", label);
+        stats.hold = &registry.AddHistogram("cppserv_lock_hold_seconds", "Time the lock was held, counts all acquisitions.", label);
+        return stats;
+    }
+
+    std::string InstrumentedMutex::Report() {
+        struct Line {
+            const LockStats* stats;
+            HistogramSnapshot wait;
+            HistogramSnapshot hold;
+        };
+        std::vector<Line> lines;
+        {
+            LockTable& table = GetLockTable();
+            std::lock_guard<std::mutex> lock(table.mutex);
+            for (const LockStats& stats : table.locks) {
+                lines.push_back({ &stats, stats.wait->Snapshot(), stats.hold->Snapshot() });
+            }
+        }
+        std::sort(lines.begin(), lines.end(), [](const Line& a, const Line& b) { return a.wait.sum > b.wait.sum; });
+
+        std::string text;
+        char buffer[512];
+        for (const Line& line : lines) {
+            double contended = line.hold.count > 0 ? 100.0 * (double)line.wait.count / (double)line.hold.count : 0.0;
+            snprintf(buffer, sizeof(buffer),
+                "lock %s: %llu acquisitions, %llu contended (%.2f%%), wait total %.3fms p99 %.1fus, hold total %.3fms p99 %.1fus\n",
+                line.stats->name.c_str(), (unsigned long long)line.hold.count, (unsigned long long)line.wait.count, contended,
+                (double)line.wait.sum / 1e6, (double)line.wait.Percentile(0.99) / 1e3,
+                (double)line.hold.sum / 1e6, (double)line.hold.Percentile(0.99) / 1e3);
+            text += buffer;
+        }
+        return text;
+    }
+
+} // namespace cppserv
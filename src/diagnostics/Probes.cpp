@@ -0,0 +1,19 @@
+#include "Probes.h"
+
+#ifdef CPPSERV_USDT
+
+// the semaphores live in the .probes section, where tracers look them up through the probe notes
+#define CPPSERV_DEFINE_PROBE_SEMAPHORE(name) \
+    volatile unsigned short CPPSERV_PROBE_SEMAPHORE(name) __attribute__((section(".probes"))) = 0
+
+extern "C" {
+    CPPSERV_DEFINE_PROBE_SEMAPHORE(accept);
+    CPPSERV_DEFINE_PROBE_SEMAPHORE(read);
+    CPPSERV_DEFINE_PROBE_SEMAPHORE(parse);
+    CPPSERV_DEFINE_PROBE_SEMAPHORE(submit);
+    CPPSERV_DEFINE_PROBE_SEMAPHORE(task_start);
+    CPPSERV_DEFINE_PROBE_SEMAPHORE(task_end);
+    CPPSERV_DEFINE_PROBE_SEMAPHORE(write);
+}
+
+#endif
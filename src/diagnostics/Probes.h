@@ -0,0 +1,72 @@
+#ifndef __PROBES_H__
+#define __PROBES_H__
+
+/**
+ * \brief USDT (SystemTap SDT) static tracepoints of the `cppserv` provider.
+ *
+ * A probe compiles to a single `nop` plus an ELF note describing where its arguments live, so it costs
+ * nothing until a tracer attaches. List them with `bpftrace -l 'usdt:./cppserv:*'` or
+ * `perf list sdt_cppserv:*`, e.g.
+ *
+ *     bpftrace -e 'usdt:./cppserv:cppserv:task_end { @run = hist(arg0); }'
+ *
+ * Probes and their arguments:
+ *
+ * | probe      | arg0                  | arg1                 | arg2                        |
+ * |------------|-----------------------|----------------------|-----------------------------|
+ * | accept     | listening fd          | accepted fd (<0 err) |                             |
+ * | read       | fd                    | bytes requested      | bytes read (<0 error)       |
+ * | parse      | bytes in the buffer   | parse result*        | parse time in ns            |
+ * | submit     | queue depth after     |                      |                             |
+ * | task_start | queue wait in ns      |                      |                             |
+ * | task_end   | run time in ns        |                      |                             |
+ * | write      | fd                    | bytes requested      | bytes written (<0 error)    |
+ *
+ * *parse result: request size in bytes, 0 (HTTP_PARSE_INCOMPLETE), -1 (HTTP_PARSE_ERROR) or -2 (HTTP_PARSE_TOO_LARGE).
+ *
+ * The probes are compiled in when `<sys/sdt.h>` is available (systemtap-sdt-dev / systemtap-sdt-devel)
+ * and CPPSERV_NO_USDT is not defined; otherwise they expand to nothing and their arguments are not
+ * evaluated.
+ *
+ * Every probe has an SDT semaphore that the tracer increments while it is attached. Arguments that
+ * cost more than a register load (e.g. a clock read) are only computed under
+ * `if (CPPSERV_PROBE_ENABLED(name))`, which is a load of that counter and constant false without USDT.
+ * A new probe needs its semaphore declared below and defined in Probes.cpp.
+ */
+
+#if !defined(CPPSERV_NO_USDT) && defined(__has_include)
+    #if __has_include(<sys/sdt.h>)
+        #define CPPSERV_USDT 1
+    #endif
+#endif
+
+#ifdef CPPSERV_USDT
+    #define _SDT_HAS_SEMAPHORES 1
+    #include <sys/sdt.h>
+
+    #define CPPSERV_PROBE_SEMAPHORE(name) cppserv_##name##_semaphore
+
+    extern "C" {
+        extern volatile unsigned short CPPSERV_PROBE_SEMAPHORE(accept);
+        extern volatile unsigned short CPPSERV_PROBE_SEMAPHORE(read);
+        extern volatile unsigned short CPPSERV_PROBE_SEMAPHORE(parse);
+        extern volatile unsigned short CPPSERV_PROBE_SEMAPHORE(submit);
+        extern volatile unsigned short CPPSERV_PROBE_SEMAPHORE(task_start);
+        extern volatile unsigned short CPPSERV_PROBE_SEMAPHORE(task_end);
+        extern volatile unsigned short CPPSERV_PROBE_SEMAPHORE(write);
+    }
+
+    #define CPPSERV_PROBE_ENABLED(name) __builtin_expect(CPPSERV_PROBE_SEMAPHORE(name) != 0, 0)
+
+    #define CPPSERV_PROBE1(name, a) DTRACE_PROBE1(cppserv, name, a)
+    #define CPPSERV_PROBE2(name, a, b) DTRACE_PROBE2(cppserv, name, a, b)
+    #define CPPSERV_PROBE3(name, a, b, c) DTRACE_PROBE3(cppserv, name, a, b, c)
+#else
+    #define CPPSERV_PROBE_ENABLED(name) false
+
+    #define CPPSERV_PROBE1(name, a) do {} while (0)
+    #define CPPSERV_PROBE2(name, a, b) do {} while (0)
+    #define CPPSERV_PROBE3(name, a, b, c) do {} while (0)
+#endif
+
+#endif // __PROBES_H__
@@ -0,0 +1,348 @@
+#include "SamplingProfiler.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <charconv>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "../admin/AdminRegistry.h"
+#include "../logger/Logger.h"
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace cppserv {
+
+    struct ProfiledThread {
+        int tid;
+        std::string name;
+        clockid_t clock;
+    };
+
+    /**
+     * \brief One stack, filled in by the signal handler.
+     */
+    struct ProfileSample {
+        int tid;
+        int depth;
+        void* frames[PROFILER_MAX_DEPTH];
+    };
+
+    enum class ProfileMode : int {
+        NONE = 0,
+        PERF_EVENT,
+        CPU_TIMER
+    };
+
+    static std::mutex s_ThreadsMutex;
+    static std::vector<ProfiledThread> s_Threads;
+
+    static std::mutex s_ProfileMutex;
+    static bool s_HandlerInstalled = false;
+
+    // shared with the signal handler
+    static ProfileSample* s_Samples = nullptr;
+    static size_t s_Capacity = 0;
+    static std::atomic<size_t> s_Next = 0;
+    static std::atomic<int> s_Mode = (int)ProfileMode::NONE;
+    static std::atomic<int> s_InHandler = 0;
+
+    // the handler and the sigreturn trampoline
+    static constexpr int SKIPPED_FRAMES = 2;
+
+    static void HandleProfileSignal(int, siginfo_t* info, void*) {
+        s_InHandler.fetch_add(1, std::memory_order_acquire);
+        int mode = s_Mode.load(std::memory_order_acquire);
+        if (mode != (int)ProfileMode::NONE) {
+            int savedErrno = errno;
+            size_t index = s_Next.fetch_add(1, std::memory_order_relaxed);
+            if (index < s_Capacity) {
+                ProfileSample& sample = s_Samples[index];
+                sample.tid = (int)syscall(SYS_gettid);
+                sample.depth = backtrace(sample.frames, (int)PROFILER_MAX_DEPTH);
+            }
+            // a perf event is disabled after every overflow (reported as POLL_HUP), re-arm it for the next one
+            if (mode == (int)ProfileMode::PERF_EVENT && (info->si_code == POLL_HUP || info->si_code == POLL_IN)) {
+                ioctl(info->si_fd, PERF_EVENT_IOC_REFRESH, 1);
+            }
+            errno = savedErrno;
+        }
+        s_InHandler.fetch_sub(1, std::memory_order_release);
+    }
+
+    void SamplingProfiler::RegisterThread(const std::string& name) {
+        ProfiledThread thread;
+        thread.tid = (int)syscall(SYS_gettid);
+        thread.name = name;
+        if (pthread_getcpuclockid(pthread_self(), &thread.clock) != 0) {
+            thread.clock = CLOCK_THREAD_CPUTIME_ID;
+        }
+        std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+        s_Threads.push_back(std::move(thread));
+    }
+
+    static int OpenPerfEvent(int tid, unsigned frequency) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = PERF_COUNT_SW_TASK_CLOCK;
+        attr.sample_period = 1000000000ull / frequency;
+        attr.wakeup_events = 1;
+        attr.disabled = 1;
+        // only user time: a sample taken in a syscall would interrupt it (poll does not restart)
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        int fd = (int)syscall(SYS_perf_event_open, &attr, tid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+        if (fd < 0) {
+            return -1;
+        }
+        struct f_owner_ex owner = { F_OWNER_TID, tid };
+        if (fcntl(fd, F_SETFL, O_ASYNC) < 0 || fcntl(fd, F_SETSIG, SIGPROF) < 0 || fcntl(fd, F_SETOWN_EX, &owner) < 0) {
+            CPPSERV_ERROR("fcntl error: {}", strerror(errno));
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    static int CreateCpuTimer(const ProfiledThread& thread, unsigned frequency, timer_t& timer) {
+        struct sigevent event;
+        memset(&event, 0, sizeof(event));
+        event.sigev_notify = SIGEV_THREAD_ID;
+        event.sigev_signo = SIGPROF;
+        event.sigev_notify_thread_id = thread.tid;
+        if (timer_create(thread.clock, &event, &timer) < 0) {
+            return -1;
+        }
+        struct itimerspec spec;
+        uint64_t period = 1000000000ull / frequency;
+        spec.it_interval.tv_sec = (time_t)(period / 1000000000ull);
+        spec.it_interval.tv_nsec = (long)(period % 1000000000ull);
+        spec.it_value = spec.it_interval;
+        if (timer_settime(timer, 0, &spec, nullptr) < 0) {
+            CPPSERV_ERROR("timer_settime error: {}", strerror(errno));
+            timer_delete(timer);
+            return -1;
+        }
+        return 0;
+    }
+
+    static std::string FrameName(void* address) {
+        Dl_info info;
+        // return addresses point behind the call, look up the call itself
+        if (dladdr((char*)address - 1, &info) == 0) {
+            char text[32];
+            snprintf(text, sizeof(text), "%p", address);
+            return text;
+        }
+        std::string name;
+        if (info.dli_sname != nullptr) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            name = status == 0 && demangled != nullptr ? demangled : info.dli_sname;
+            free(demangled);
+        } else {
+            const char* module = info.dli_fname != nullptr ? info.dli_fname : "?";
+            const char* slash = strrchr(module, '/');
+            char offset[32];
+            snprintf(offset, sizeof(offset), "+0x%zx", (size_t)((char*)address - (char*)info.dli_fbase));
+            name = std::string(slash != nullptr ? slash + 1 : module) + offset;
+        }
+        // ';' separates the frames of a collapsed stack
+        std::replace(name.begin(), name.end(), ';', ':');
+        return name;
+    }
+
+    static std::string Collapse(const ProfileSample* samples, size_t count, const std::vector<ProfiledThread>& threads) {
+        std::unordered_map<int, const std::string*> threadNames;
+        for (const ProfiledThread& thread : threads) {
+            threadNames[thread.tid] = &thread.name;
+        }
+
+        std::unordered_map<void*, std::string> frameNames;
+        std::map<std::string, uint64_t> stacks;
+        std::string stack;
+        for (size_t i = 0; i < count; i++) {
+            const ProfileSample& sample = samples[i];
+            auto thread = threadNames.find(sample.tid);
+            stack = thread != threadNames.end() ? *thread->second : "thread-" + std::to_string(sample.tid);
+            // backtrace lists the innermost frame first, collapsed stacks start with the outermost
+            for (int frame = sample.depth - 1; frame >= SKIPPED_FRAMES; frame--) {
+                void* address = sample.frames[frame];
+                auto it = frameNames.find(address);
+                if (it == frameNames.end()) {
+                    it = frameNames.emplace(address, FrameName(address)).first;
+                }
+                stack += ';';
+                stack += it->second;
+            }
+            stacks[stack]++;
+        }
+
+        std::vector<std::pair<const std::string*, uint64_t> > sorted;
+        for (const auto& [collapsed, hits] : stacks) {
+            sorted.emplace_back(&collapsed, hits);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+
+        std::string text;
+        for (const auto& [collapsed, hits] : sorted) {
+            text += *collapsed;
+            text += ' ';
+            text += std::to_string(hits);
+            text += '\n';
+        }
+        return text;
+    }
+
+    int SamplingProfiler::Profile(unsigned seconds, unsigned frequency, ProfileResult& result) {
+        std::unique_lock<std::mutex> profileLock(s_ProfileMutex, std::try_to_lock);
+        if (!profileLock.owns_lock()) {
+            return -1;
+        }
+        frequency = std::max(frequency, 1u);
+
+        std::vector<ProfiledThread> threads;
+        {
+            std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+            threads = s_Threads;
+        }
+        if (threads.empty()) {
+            return -1;
+        }
+
+        if (!s_HandlerInstalled) {
+            // backtrace loads libgcc on its first call, which must not happen in the signal handler
+            void* warmup[4];
+            backtrace(warmup, 4);
+
+            // stays installed: a SIGPROF that is still pending after a profile must not terminate the process
+            struct sigaction action;
+            memset(&action, 0, sizeof(action));
+            action.sa_sigaction = HandleProfileSignal;
+            action.sa_flags = SA_SIGINFO | SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            if (sigaction(SIGPROF, &action, nullptr) < 0) {
+                CPPSERV_ERROR("sigaction error: {}", strerror(errno));
+                return -1;
+            }
+            s_HandlerInstalled = true;
+        }
+
+        size_t capacity = std::min<size_t>(PROFILER_MAX_SAMPLES, (size_t)seconds * frequency * threads.size() + 64);
+        std::unique_ptr<ProfileSample[]> samples(new ProfileSample[capacity]);
+        s_Samples = samples.get();
+        s_Capacity = capacity;
+        s_Next.store(0, std::memory_order_relaxed);
+
+        // perf events first, CPU timers for all threads once the kernel refuses them
+        ProfileMode mode = ProfileMode::PERF_EVENT;
+        std::vector<int> events;
+        std::vector<timer_t> timers;
+        for (const ProfiledThread& thread : threads) {
+            int fd = OpenPerfEvent(thread.tid, frequency);
+            if (fd < 0) {
+                if (events.empty() && (errno == EACCES || errno == EPERM || errno == ENOSYS || errno == ENOENT || errno == EOPNOTSUPP)) {
+                    mode = ProfileMode::CPU_TIMER;
+                    break;
+                }
+                CPPSERV_WARN("perf_event_open error for thread {}: {}", thread.tid, strerror(errno));
+                continue;
+            }
+            events.push_back(fd);
+        }
+        s_Mode.store((int)mode, std::memory_order_release);
+
+        if (mode == ProfileMode::PERF_EVENT) {
+            for (int fd : events) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_REFRESH, 1);
+            }
+        } else {
+            for (const ProfiledThread& thread : threads) {
+                timer_t timer;
+                if (CreateCpuTimer(thread, frequency, timer) < 0) {
+                    CPPSERV_WARN("timer_create error for thread {}: {}", thread.tid, strerror(errno));
+                    continue;
+                }
+                timers.push_back(timer);
+            }
+        }
+        size_t sampled = mode == ProfileMode::PERF_EVENT ? events.size() : timers.size();
+
+        if (sampled > 0) {
+            std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        }
+
+        for (int fd : events) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            close(fd);
+        }
+        for (timer_t timer : timers) {
+            timer_delete(timer);
+        }
+        s_Mode.store((int)ProfileMode::NONE, std::memory_order_release);
+        // a handler that saw the profile running may still be writing its sample
+        while (s_InHandler.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+        s_Samples = nullptr;
+        s_Capacity = 0;
+
+        if (sampled == 0) {
+            return -1;
+        }
+        size_t taken = s_Next.load(std::memory_order_relaxed);
+        result.mode = mode == ProfileMode::PERF_EVENT ? "perf_event" : "cpu_timer";
+        result.threads = sampled;
+        result.samples = std::min(taken, capacity);
+        result.dropped = taken - result.samples;
+        result.collapsed = Collapse(samples.get(), (size_t)result.samples, threads);
+        return 0;
+    }
+
+    static unsigned QueryNumber(std::string_view query, std::string_view name, unsigned fallback, unsigned maximum) {
+        std::string_view value = AdminRegistry::GetQueryValue(query, name);
+        unsigned number = 0;
+        auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), number);
+        if (value.empty() || error != std::errc() || number == 0) {
+            return fallback;
+        }
+        return std::min(number, maximum);
+    }
+
+    std::string SamplingProfiler::HandleAdmin(std::string_view query) {
+        unsigned seconds = QueryNumber(query, "seconds", 10, 60);
+        unsigned frequency = QueryNumber(query, "hz", 99, 1000);
+
+        ProfileResult result;
+        if (Profile(seconds, frequency, result) < 0) {
+            return "error: a profile is already running or no thread can be sampled\n";
+        }
+        CPPSERV_INFO("Profiled {} threads for {}s with {}: {} samples, {} dropped", result.threads, seconds, result.mode,
+            result.samples, result.dropped);
+        return std::move(result.collapsed);
+    }
+
+} // namespace cppserv
@@ -0,0 +1,79 @@
+#ifndef __SAMPLINGPROFILER_H__
+#define __SAMPLINGPROFILER_H__
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+namespace cppserv {
+
+    /**
+     * \brief Maximum number of frames kept of every sampled stack.
+     */
+    constexpr size_t PROFILER_MAX_DEPTH = 64;
+
+    /**
+     * \brief Maximum number of samples of one profile, further samples are counted as dropped.
+     */
+    constexpr size_t PROFILER_MAX_SAMPLES = 65536;
+
+    /**
+     * \brief The outcome of a profile.
+     */
+    struct ProfileResult {
+        // "perf_event" or "cpu_timer"
+        const char* mode = "";
+        size_t threads = 0;
+        uint64_t samples = 0;
+        uint64_t dropped = 0;
+        // one "thread;outermost;...;innermost count" line per distinct stack, ready for flamegraph.pl
+        std::string collapsed;
+    };
+
+    /**
+     * \brief An in-process sampling CPU profiler of the registered threads.
+     *
+     * Every registered thread gets its own CPU clock that raises SIGPROF on that thread every
+     * 1/frequency seconds of CPU time it consumed: a `perf_event_open` task clock that only counts
+     * user time (a signal in a syscall would interrupt it), or, where perf
+     * events are not permitted (containers, seccomp, perf_event_paranoid), a POSIX timer on the
+     * thread's CPU clock. The kernel only checks those timers on the scheduler tick, so threads that
+     * run in short bursts are sampled less often than with perf events. The signal handler only stores the `backtrace` of the interrupted thread
+     * into a preallocated buffer; stacks are symbolized and collapsed once the profile is over.
+     *
+     * Symbols of the executable are only resolved when it is linked with `-rdynamic`, other frames
+     * are reported as module+offset.
+     */
+    class SamplingProfiler {
+    public:
+        /**
+         * \brief Makes the calling thread part of every following profile.
+         *
+         * \param name The name the stacks of the thread are rooted at, threads may share a name.
+         */
+        static void RegisterThread(const std::string& name);
+
+        /**
+         * \brief Profiles all registered threads, blocking the caller for the duration.
+         *
+         * Only one profile runs at a time.
+         *
+         * \param seconds The duration of the profile.
+         * \param frequency The samples per second of CPU time of every thread.
+         * \param result Receives the collapsed stacks.
+         * \return Returns 0 on success, or a negative value if a profile is running or no thread could be sampled.
+         */
+        static int Profile(unsigned seconds, unsigned frequency, ProfileResult& result);
+
+        /**
+         * \brief Renders the `/admin/profile` endpoint.
+         *
+         * \param query The query string, `seconds` (default 10, at most 60) and `hz` (default 99, at most 1000).
+         * \return Returns the collapsed stacks, or a line starting with `error:`.
+         */
+        static std::string HandleAdmin(std::string_view query);
+    };
+
+} // namespace cppserv
+
+#endif // __SAMPLINGPROFILER_H__
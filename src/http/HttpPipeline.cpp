@@ -0,0 +1,95 @@
+#include "HttpPipeline.h"
+
+#include <algorithm>
+
+#include "httpparser.h"
+#include "../diagnostics/FlightRecorder.h"
+
+namespace cppserv {
+
+    static const std::string s_BadRequest = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    static const std::string s_TooLarge = "HTTP/1.1 413 Content Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+    const std::string& HttpPipeline::GetBadRequestResponse() {
+        return s_BadRequest;
+    }
+
+    const std::string& HttpPipeline::GetTooLargeResponse() {
+        return s_TooLarge;
+    }
+
+    static void MarkBoundary(HttpExchange& exchange, RequestTimestamp boundary) {
+        exchange.timeline->Mark(boundary);
+        if (exchange.counters != nullptr) {
+            exchange.counters->Mark(boundary);
+        }
+    }
+
+    bool HttpPipeline::Parse(HttpExchange& exchange) {
+        exchange.parsed = HTTP_PARSE_INCOMPLETE;
+        if (exchange.buffered > 0) {
+            exchange.parsed = HttpParser::Parse(std::string_view(exchange.buffer, exchange.buffered), *exchange.request, exchange.capacity);
+        }
+        return exchange.parsed != HTTP_PARSE_INCOMPLETE || exchange.buffered >= exchange.capacity;
+    }
+
+    bool HttpPipeline::Received(HttpExchange& exchange, size_t received) {
+        if (exchange.timeline->timestamps[TIMESTAMP_FIRST_BYTE] == 0) {
+            MarkBoundary(exchange, TIMESTAMP_FIRST_BYTE);
+        }
+        FlightRecorder::Record(exchange.connectionId, FlightStage::READ, HttpMethod::NOT_IMPLEMENTED, 0,
+            (uint16_t)std::min<size_t>(received, 0xffff));
+        exchange.buffered += received;
+        return Parse(exchange);
+    }
+
+    const std::string* HttpPipeline::Route(HttpExchange& exchange, const HttpRouter& router, const std::string& defaultResponse) {
+        HttpRequest& request = *exchange.request;
+        const std::string* response = nullptr;
+        if (exchange.parsed > 0) {
+            MarkBoundary(exchange, TIMESTAMP_PARSED);
+            exchange.pathHash = FlightRecorder::HashPath(request.GetPath());
+            FlightRecorder::Record(exchange.connectionId, FlightStage::PARSED, request.GetMethod(), exchange.pathHash);
+            response = router ? router(request) : nullptr;
+            if (response == nullptr) {
+                response = &defaultResponse;
+            }
+            exchange.status = 200;
+        } else if (exchange.parsed == HTTP_PARSE_ERROR) {
+            response = &s_BadRequest;
+            exchange.status = 400;
+        } else if (exchange.parsed == HTTP_PARSE_TOO_LARGE || exchange.buffered == exchange.capacity) {
+            response = &s_TooLarge;
+            exchange.status = 413;
+        }
+        MarkBoundary(exchange, TIMESTAMP_HANDLED);
+        exchange.response = response;
+        return response;
+    }
+
+    void HttpPipeline::Written(HttpExchange& exchange) {
+        if (exchange.response != nullptr) {
+            FlightRecorder::Record(exchange.connectionId, FlightStage::RESPONSE, exchange.request->GetMethod(), exchange.pathHash, exchange.status);
+        }
+        MarkBoundary(exchange, TIMESTAMP_WRITTEN);
+    }
+
+    void HttpPipeline::Serve(Transport& transport, HttpExchange& exchange, const HttpRouter& router,
+        const std::string& defaultResponse, int readTimeout) {
+        bool complete = Parse(exchange);
+        while (!complete) {
+            int received = transport.SafeRead(exchange.buffer + exchange.buffered, exchange.capacity - exchange.buffered, readTimeout);
+            if (received <= 0) {
+                break;
+            }
+            complete = Received(exchange, (size_t)received);
+        }
+
+        const std::string* response = Route(exchange, router, defaultResponse);
+        if (response != nullptr) {
+            transport.Write(response->data(), response->size());
+        }
+        Written(exchange);
+    }
+
+} // namespace cppserv
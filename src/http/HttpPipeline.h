@@ -0,0 +1,111 @@
+#ifndef __HTTPPIPELINE_H__
+#define __HTTPPIPELINE_H__
+
+#include <string>
+#include <functional>
+#include <cstdint>
+
+#include "httprequest.h"
+#include "../transport/Transport.h"
+#include "../metrics/RequestTimeline.h"
+#include "../metrics/HardwareCounters.h"
+
+namespace cppserv {
+
+    /**
+     * \brief Returns the response of a parsed request, or nullptr to send the default response.
+     */
+    using HttpRouter = std::function<const std::string*(const HttpRequest& request)>;
+
+    /**
+     * \brief Seconds a peer may stay silent before its connection is closed: per read, and for the TLS handshake.
+     */
+    constexpr int HTTP_READ_TIMEOUT = 10;
+
+    /**
+     * \brief The state of one request passing through the pipeline.
+     */
+    struct HttpExchange {
+        // inputs
+        char* buffer = nullptr;
+        size_t capacity = 0;
+        HttpRequest* request = nullptr;
+        RequestTimeline* timeline = nullptr;
+        // read at every timeline boundary if set
+        HardwareTimeline* counters = nullptr;
+        uint64_t connectionId = 0;
+        // bytes of buffer in use, bytes already in the buffer are parsed before reading more
+        size_t buffered = 0;
+
+        // results
+        int parsed = 0;
+        uint16_t status = 0;
+        uint32_t pathHash = 0;
+        const std::string* response = nullptr;
+    };
+
+    /**
+     * \brief Reads, parses, routes and answers one request over any Transport.
+     *
+     * The server drives it over sockets and TLS sessions, benchmarks over a LoopbackTransport to
+     * measure the request path without the kernel. Callers that do their own I/O, like the coroutine
+     * server that suspends instead of blocking, run the stages of `Serve` themselves: `Parse` the bytes
+     * already buffered, `Received` after every read until it returns true, `Route`, write the response
+     * if there is one, then `Written`.
+     */
+    class HttpPipeline {
+    public:
+        /**
+         * \brief Serves one request.
+         *
+         * Reads into the exchange buffer until a request is parsed, the buffer is full or the transport
+         * stops delivering data, then writes the response: the one of the router for a parsed request,
+         * 400 for a malformed and 413 for an oversized request. Nothing is written when the peer closed
+         * or timed out before sending a complete request.
+         *
+         * \param transport The transport to read the request from and write the response to.
+         * \param exchange The buffer and request to use, receives the outcome.
+         * \param router Selects the response of a parsed request.
+         * \param defaultResponse The response when the router returns nullptr.
+         * \param readTimeout The timeout of each read in seconds.
+         */
+        static void Serve(Transport& transport, HttpExchange& exchange, const HttpRouter& router,
+            const std::string& defaultResponse, int readTimeout = HTTP_READ_TIMEOUT);
+
+        /**
+         * \brief Parses the bytes already in the exchange buffer.
+         *
+         * \param exchange The exchange, `parsed` receives the parse result.
+         * \return Returns true once no more data is needed: the request is complete, malformed, too large or the buffer is full.
+         */
+        static bool Parse(HttpExchange& exchange);
+
+        /**
+         * \brief Accounts for bytes read into the exchange buffer and parses again.
+         *
+         * \param exchange The exchange.
+         * \param received The number of bytes read behind `buffered`, must be greater than 0.
+         * \return Returns true once no more data is needed, see `Parse`.
+         */
+        static bool Received(HttpExchange& exchange, size_t received);
+
+        /**
+         * \brief Selects the response of the exchange and sets `status` and `response`.
+         *
+         * \return Returns the response to write, or nullptr if the peer closed or timed out before sending a complete request.
+         */
+        static const std::string* Route(HttpExchange& exchange, const HttpRouter& router, const std::string& defaultResponse);
+
+        /**
+         * \brief Records that the response was written.
+         */
+        static void Written(HttpExchange& exchange);
+
+        static const std::string& GetBadRequestResponse();
+        static const std::string& GetTooLargeResponse();
+    };
+
+} // namespace cppserv
+
+
+#endif // __HTTPPIPELINE_H__
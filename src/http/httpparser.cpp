@@ -0,0 +1,110 @@
+#include "httpparser.h"
+#include "../diagnostics/Probes.h"
+#include "../metrics/TscClock.h"
+
+#include <algorithm>
+#include <charconv>
+
+namespace cppserv {
+
+    static std::string_view Trim(std::string_view value) {
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+            value.remove_prefix(1);
+        }
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+            value.remove_suffix(1);
+        }
+        return value;
+    }
+
+    static bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int HttpParser::Parse(std::string_view data, HttpRequest& request, size_t capacity) {
+#ifdef CPPSERV_USDT
+        if (CPPSERV_PROBE_ENABLED(parse)) {
+            uint64_t start = TscClock::Now();
+            int result = ParseRequest(data, request, capacity);
+            CPPSERV_PROBE3(parse, data.size(), result, TscClock::Between(start, TscClock::Now()));
+            return result;
+        }
+#endif
+        return ParseRequest(data, request, capacity);
+    }
+
+    int HttpParser::ParseRequest(std::string_view data, HttpRequest& request, size_t capacity) {
+        size_t headerEnd = data.find("\r\n\r\n");
+        if (headerEnd == std::string_view::npos) {
+            return HTTP_PARSE_INCOMPLETE;
+        }
+        std::string_view head = data.substr(0, headerEnd + 2);
+
+        // request line: METHOD SP TARGET SP VERSION CRLF
+        size_t lineEnd = head.find("\r\n");
+        std::string_view line = head.substr(0, lineEnd);
+        size_t first = line.find(' ');
+        size_t last = line.rfind(' ');
+        if (first == std::string_view::npos || first == last) {
+            return HTTP_PARSE_ERROR;
+        }
+        HttpVersion version = HttpVersionFromString(line.substr(last + 1));
+        std::string_view path = line.substr(first + 1, last - first - 1);
+        if (version == HttpVersion::NOT_IMPLEMENTED || path.empty()) {
+            return HTTP_PARSE_ERROR;
+        }
+
+        // headers, validated before anything is copied into the request
+        size_t contentLength = 0;
+        size_t pos = lineEnd + 2;
+        while (pos < head.size()) {
+            size_t end = head.find("\r\n", pos);
+            std::string_view field = head.substr(pos, end - pos);
+            size_t colon = field.find(':');
+            if (colon == std::string_view::npos || colon == 0) {
+                return HTTP_PARSE_ERROR;
+            }
+            if (EqualsIgnoreCase(field.substr(0, colon), "content-length")) {
+                std::string_view value = Trim(field.substr(colon + 1));
+                auto result = std::from_chars(value.data(), value.data() + value.size(), contentLength);
+                if (result.ec != std::errc() || result.ptr != value.data() + value.size()) {
+                    return HTTP_PARSE_ERROR;
+                }
+            }
+            pos = end + 2;
+        }
+
+        // checked before adding, a hostile Content-Length must neither wrap the sum nor the int result
+        size_t limit = std::min<size_t>(capacity, INT_MAX);
+        if (headerEnd + 4 > limit || contentLength > limit - (headerEnd + 4)) {
+            return HTTP_PARSE_TOO_LARGE;
+        }
+        size_t total = headerEnd + 4 + contentLength;
+        if (data.size() < total) {
+            return HTTP_PARSE_INCOMPLETE;
+        }
+
+        request.SetMethod(HttpMethodFromString(line.substr(0, first)));
+        request.SetVersion(version);
+        request.SetPath(path);
+        pos = lineEnd + 2;
+        while (pos < head.size()) {
+            size_t end = head.find("\r\n", pos);
+            std::string_view field = head.substr(pos, end - pos);
+            size_t colon = field.find(':');
+            request.SetHeader(field.substr(0, colon), Trim(field.substr(colon + 1)));
+            pos = end + 2;
+        }
+        request.SetBody(data.substr(headerEnd + 4, contentLength));
+        return (int)total;
+    }
+
+} // namespace cppserv
@@ -0,0 +1,39 @@
+#ifndef __HTTPPARSER_H__
+#define __HTTPPARSER_H__
+
+#include <string_view>
+#include <climits>
+
+#include "httprequest.h"
+
+namespace cppserv {
+
+    constexpr int HTTP_PARSE_INCOMPLETE = 0;
+    constexpr int HTTP_PARSE_ERROR = -1;
+    constexpr int HTTP_PARSE_TOO_LARGE = -2;
+
+    class HttpParser {
+    public:
+        /**
+         * \brief Parses an HTTP/1.x request.
+         *
+         * This function parses the request line, the headers and, if a Content-Length header is present,
+         * the body. It can be called again with more data after it returned `HTTP_PARSE_INCOMPLETE`; the
+         * request is only filled once the whole message is available.
+         *
+         * \param data The raw bytes received so far.
+         * \param request Reference to the request that receives the parsed message.
+         * \param capacity The size of the buffer `data` is received into, at most INT_MAX is used.
+         * \return Returns the number of bytes the request occupies, `HTTP_PARSE_INCOMPLETE` if more data is needed,
+         *         `HTTP_PARSE_TOO_LARGE` if the Content-Length does not fit into `capacity`, or `HTTP_PARSE_ERROR` for a malformed request.
+         */
+        static int Parse(std::string_view data, HttpRequest& request, size_t capacity = INT_MAX);
+
+    private:
+        static int ParseRequest(std::string_view data, HttpRequest& request, size_t capacity);
+    };
+
+} // namespace cppserv
+
+
+#endif // __HTTPPARSER_H__
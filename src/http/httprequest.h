@@ -1,27 +1,86 @@
 #ifndef __HTTPREQUEST_H__
 #define __HTTPREQUEST_H__
 
+#include <ctype.h>
 #include <string>
+#include <string_view>
 #include <map>
+#include <memory_resource>
 
 #include "httputil.h"
 
 namespace cppserv {
 
+    /**
+     * \brief A parsed HTTP request.
+     *
+     * All strings and map nodes are allocated from the memory resource passed to the constructor,
+     * normally the RequestArena of the worker, so a request does not touch the heap and is released
+     * as a whole when the arena is reset.
+     */
     class HttpRequest {
     public:
-        HttpRequest() {}
+        using String = std::pmr::string;
+        using StringMap = std::pmr::map<String, String, std::less<> >;
+
+        explicit HttpRequest(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : m_Method(HttpMethod::NOT_IMPLEMENTED), m_Version(HttpVersion::NOT_IMPLEMENTED),
+              m_Path(resource), m_Headers(resource), m_Params(resource), m_Body(resource) {}
         ~HttpRequest() {}
 
+        HttpMethod GetMethod() const { return m_Method; }
+        HttpVersion GetVersion() const { return m_Version; }
+        const String& GetPath() const { return m_Path; }
+        const String& GetBody() const { return m_Body; }
+        const StringMap& GetHeaders() const { return m_Headers; }
+        const StringMap& GetParams() const { return m_Params; }
+
+        /**
+         * \brief Looks up a header by its lower case name.
+         *
+         * \param name The lower case header name.
+         * \return Returns the header value, or an empty view if the header is not present.
+         */
+        std::string_view GetHeader(std::string_view name) const {
+            auto it = m_Headers.find(name);
+            return it != m_Headers.end() ? std::string_view(it->second) : std::string_view();
+        }
+
+        /**
+         * \brief Looks up a routing parameter.
+         *
+         * \param name The parameter name.
+         * \return Returns the parameter value, or an empty view if the parameter is not set.
+         */
+        std::string_view GetParam(std::string_view name) const {
+            auto it = m_Params.find(name);
+            return it != m_Params.end() ? std::string_view(it->second) : std::string_view();
+        }
+
+        void SetMethod(HttpMethod method) { m_Method = method; }
+        void SetVersion(HttpVersion version) { m_Version = version; }
+        void SetPath(std::string_view path) { m_Path.assign(path); }
+        void SetBody(std::string_view body) { m_Body.assign(body); }
+        void SetHeader(std::string_view name, std::string_view value) {
+            String key(name, m_Headers.get_allocator());
+            for (char& c : key) {
+                c = (char)tolower((unsigned char)c);
+            }
+            m_Headers.emplace(std::move(key), value);
+        }
+
+        void SetParam(std::string_view name, std::string_view value) { m_Params.emplace(name, value); }
+
     private:
         HttpMethod m_Method;
         HttpVersion m_Version;
-        std::string m_Path;
-        std::map<std::string, std::string> m_Headers;
-        std::string m_Body;
+        String m_Path;
+        StringMap m_Headers;
+        StringMap m_Params;
+        String m_Body;
     };
 
 } // namespace cppserv
 
 
-#endif // __HTTPREQUEST_H__
\ No newline at end of file
+#endif // __HTTPREQUEST_H__
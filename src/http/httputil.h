@@ -1,6 +1,9 @@
 #ifndef __HTTPUTIL_H__
 #define __HTTPUTIL_H__
 
+#include <string>
+#include <string_view>
+
 namespace cppserv {
 
     enum class HttpMethod {
@@ -26,7 +29,76 @@ namespace cppserv {
         NOT_IMPLEMENTED
     };
 
+    inline HttpMethod HttpMethodFromString(std::string_view method) {
+        switch (method.size()) {
+        case 3:
+            if (method == "GET") return HttpMethod::GET;
+            if (method == "PUT") return HttpMethod::PUT;
+            break;
+        case 4:
+            if (method == "POST") return HttpMethod::POST;
+            if (method == "HEAD") return HttpMethod::HEAD;
+            if (method == "LINK") return HttpMethod::LINK;
+            break;
+        case 5:
+            if (method == "TRACE") return HttpMethod::TRACE;
+            if (method == "PATCH") return HttpMethod::PATCH;
+            break;
+        case 6:
+            if (method == "DELETE") return HttpMethod::DELETE;
+            if (method == "UNLINK") return HttpMethod::UNLINK;
+            break;
+        case 7:
+            if (method == "OPTIONS") return HttpMethod::OPTIONS;
+            if (method == "CONNECT") return HttpMethod::CONNECT;
+            break;
+        }
+        return HttpMethod::NOT_IMPLEMENTED;
+    }
+
+    inline const char* HttpMethodToString(HttpMethod method) {
+        switch (method) {
+        case HttpMethod::OPTIONS: return "OPTIONS";
+        case HttpMethod::GET: return "GET";
+        case HttpMethod::HEAD: return "HEAD";
+        case HttpMethod::POST: return "POST";
+        case HttpMethod::PUT: return "PUT";
+        case HttpMethod::DELETE: return "DELETE";
+        case HttpMethod::TRACE: return "TRACE";
+        case HttpMethod::CONNECT: return "CONNECT";
+        case HttpMethod::PATCH: return "PATCH";
+        case HttpMethod::LINK: return "LINK";
+        case HttpMethod::UNLINK: return "UNLINK";
+        default: return "NOT_IMPLEMENTED";
+        }
+    }
+
+    inline HttpVersion HttpVersionFromString(std::string_view version) {
+        if (version == "HTTP/1.1") return HttpVersion::HTTP_1_1;
+        if (version == "HTTP/1.0") return HttpVersion::HTTP_1_0;
+        if (version == "HTTP/2.0" || version == "HTTP/2") return HttpVersion::HTTP_2_0;
+        if (version == "HTTP/3.0" || version == "HTTP/3") return HttpVersion::HTTP_3_0;
+        return HttpVersion::NOT_IMPLEMENTED;
+    }
+
+    /**
+     * \brief Builds a `200 OK` plain text response that closes the connection.
+     *
+     * \param body The body of the response.
+     * \return Returns the serialized response.
+     */
+    inline std::string BuildTextResponse(std::string_view body) {
+        std::string length = std::to_string(body.size());
+        std::string response;
+        response.reserve(128 + body.size());
+        response.append("HTTP/1.1 200 OK\r\nContent-Type: text/plain; charset=utf-8\r\nContent-Length: ");
+        response.append(length);
+        response.append("\r\nConnection: close\r\n\r\n");
+        response.append(body);
+        return response;
+    }
+
 } // namespace cppserv
 
 
-#endif // __HTTPUTIL_H__
\ No newline at end of file
+#endif // __HTTPUTIL_H__
@@ -0,0 +1,219 @@
+#include "AccessLog.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <string.h>
+
+#include "Logger.h"
+#include "../diagnostics/InstrumentedMutex.h"
+
+namespace cppserv {
+
+    std::atomic<bool> AccessLog::s_Enabled = false;
+    AccessLogConfig AccessLog::s_Config;
+
+    static InstrumentedMutex s_WritersMutex("access_log_writers");
+    static std::vector<AccessLogWriter*> s_Writers;
+    static std::atomic<uint32_t> s_NextWorker = 0;
+
+    static uint64_t RealtimeNs() {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    }
+
+    AccessLogWriter::AccessLogWriter(const AccessLogConfig& config, uint32_t worker)
+        : m_Config(config), m_Worker(worker), m_Sequence(0), m_Fd(-1), m_Segment(nullptr), m_Used(0), m_NextStringId(1) {
+
+    }
+
+    AccessLogWriter::~AccessLogWriter() {
+        Close();
+    }
+
+    int AccessLogWriter::OpenSegment() {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/access-%u-%06u.bin", m_Config.directory.c_str(), m_Worker, m_Sequence++);
+
+        m_Fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (m_Fd < 0) {
+            CPPSERV_ERROR("access log open error: {}: {}", path, strerror(errno));
+            return -1;
+        }
+        if (ftruncate(m_Fd, (off_t)m_Config.segmentBytes) < 0) {
+            CPPSERV_ERROR("access log truncate error: {}", strerror(errno));
+            ::close(m_Fd);
+            m_Fd = -1;
+            return -1;
+        }
+        void* segment = mmap(NULL, m_Config.segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_Fd, 0);
+        if (segment == MAP_FAILED) {
+            CPPSERV_ERROR("access log mmap error: {}", strerror(errno));
+            ::close(m_Fd);
+            m_Fd = -1;
+            return -1;
+        }
+        m_Segment = (char*)segment;
+
+        AccessLogFileHeader header;
+        memcpy(header.magic, ACCESS_LOG_MAGIC, sizeof(header.magic));
+        header.version = ACCESS_LOG_VERSION;
+        header.worker = m_Worker;
+        header.sequence = m_Sequence - 1;
+        header.createdNs = RealtimeNs();
+        memcpy(m_Segment, &header, sizeof(header));
+        m_Used = sizeof(header);
+
+        m_Strings.clear();
+        m_NextStringId = 1;
+        return 0;
+    }
+
+    void AccessLogWriter::Close() {
+        if (m_Segment == nullptr) {
+            return;
+        }
+        munmap(m_Segment, m_Config.segmentBytes);
+        if (ftruncate(m_Fd, (off_t)m_Used) < 0) {
+            CPPSERV_ERROR("access log truncate error: {}", strerror(errno));
+        }
+        ::close(m_Fd);
+        m_Segment = nullptr;
+        m_Fd = -1;
+    }
+
+    char* AccessLogWriter::Reserve(uint32_t type, uint32_t payloadSize) {
+        size_t needed = sizeof(AccessLogEntryHeader) + AccessLogPad(payloadSize);
+        // keep room for the end marker, which the zero filled file provides
+        if (m_Segment == nullptr || m_Used + needed + sizeof(AccessLogEntryHeader) > m_Config.segmentBytes) {
+            return nullptr;
+        }
+        AccessLogEntryHeader header = { type, payloadSize };
+        memcpy(m_Segment + m_Used, &header, sizeof(header));
+        char* payload = m_Segment + m_Used + sizeof(header);
+        m_Used += needed;
+        return payload;
+    }
+
+    uint32_t AccessLogWriter::Intern(std::string_view value) {
+        auto it = m_Strings.find(value);
+        if (it != m_Strings.end()) {
+            return it->second;
+        }
+
+        char* payload = Reserve(ACCESS_LOG_STRING, (uint32_t)(sizeof(AccessLogString) + value.size()));
+        if (payload == nullptr) {
+            return 0;
+        }
+        AccessLogString string = { m_NextStringId++, (uint32_t)value.size() };
+        memcpy(payload, &string, sizeof(string));
+        memcpy(payload + sizeof(string), value.data(), value.size());
+        if (m_Strings.size() < m_Config.maxInternedStrings) {
+            m_Strings.emplace(value, string.id);
+        }
+        return string.id;
+    }
+
+    static_assert(STAGE_COUNT == ACCESS_LOG_STAGES, "access log timings must cover all request stages");
+
+    void AccessLogWriter::Write(const AccessLogEntry& entry) {
+        // worst case: a new string, the timings, the request and the end marker
+        size_t needed = sizeof(AccessLogEntryHeader) * 4 + sizeof(AccessLogTimings) + sizeof(AccessLogRequest)
+            + AccessLogPad((uint32_t)(sizeof(AccessLogString) + entry.path.size()));
+        if (m_Segment == nullptr || m_Used + needed > m_Config.segmentBytes) {
+            // rotate before interning, so the string and the request end up in the same segment
+            Close();
+            if (OpenSegment() < 0) {
+                return;
+            }
+        }
+
+        AccessLogRequest record;
+        memset(&record, 0, sizeof(record));
+        record.timestampNs = RealtimeNs();
+        record.connectionId = entry.connectionId;
+        record.latencyNs = entry.latencyNs;
+        record.bytesIn = entry.bytesIn;
+        record.bytesOut = entry.bytesOut;
+        record.pathId = Intern(entry.path);
+        record.status = entry.status;
+        record.method = (uint8_t)entry.method;
+
+        if (entry.peer != nullptr) {
+            record.peerFamily = (uint8_t)entry.peer->ss_family;
+            if (entry.peer->ss_family == AF_INET) {
+                const struct sockaddr_in* in = (const struct sockaddr_in*)entry.peer;
+                memcpy(record.peerAddress, &in->sin_addr, sizeof(in->sin_addr));
+                record.peerPort = ntohs(in->sin_port);
+            } else if (entry.peer->ss_family == AF_INET6) {
+                const struct sockaddr_in6* in6 = (const struct sockaddr_in6*)entry.peer;
+                memcpy(record.peerAddress, &in6->sin6_addr, sizeof(in6->sin6_addr));
+                record.peerPort = ntohs(in6->sin6_port);
+            }
+        }
+
+        if (m_Config.stageTimings && entry.timeline != nullptr) {
+            AccessLogTimings timings;
+            memset(&timings, 0, sizeof(timings));
+            for (uint32_t stage = 0; stage < ACCESS_LOG_STAGES; stage++) {
+                uint64_t ns = entry.timeline->StageNanoseconds((RequestStage)stage);
+                timings.stageNs[stage] = ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns;
+            }
+            timings.receiveQueueNs = entry.receiveQueueNs > UINT32_MAX ? UINT32_MAX : (uint32_t)entry.receiveQueueNs;
+            char* timingsPayload = Reserve(ACCESS_LOG_TIMINGS, sizeof(timings));
+            if (timingsPayload != nullptr) {
+                memcpy(timingsPayload, &timings, sizeof(timings));
+            }
+        }
+
+        char* payload = Reserve(ACCESS_LOG_REQUEST, sizeof(record));
+        if (payload != nullptr) {
+            memcpy(payload, &record, sizeof(record));
+        }
+    }
+
+    int AccessLog::Init(const AccessLogConfig& config) {
+        s_Config = config;
+        if (mkdir(s_Config.directory.c_str(), 0755) < 0 && errno != EEXIST) {
+            CPPSERV_ERROR("access log directory error: {}: {}", s_Config.directory, strerror(errno));
+            return -1;
+        }
+        if (s_Config.segmentBytes < 65536) {
+            CPPSERV_ERROR("access log error: segments must be at least 64 KiB");
+            return -1;
+        }
+        s_Enabled.store(true, std::memory_order_release);
+        CPPSERV_INFO("Writing binary access log to {}", s_Config.directory);
+        return 0;
+    }
+
+    void AccessLog::Shutdown() {
+        s_Enabled.store(false, std::memory_order_release);
+        std::unique_lock<InstrumentedMutex> lock(s_WritersMutex);
+        for (AccessLogWriter* writer : s_Writers) {
+            writer->Close();
+        }
+    }
+
+    void AccessLog::Write(const AccessLogEntry& entry) {
+        if (!IsEnabled()) {
+            return;
+        }
+        static thread_local AccessLogWriter* s_Writer = nullptr;
+        if (s_Writer == nullptr) {
+            // writers live until the process exits, Shutdown closes their segments
+            s_Writer = new AccessLogWriter(s_Config, s_NextWorker.fetch_add(1));
+            std::unique_lock<InstrumentedMutex> lock(s_WritersMutex);
+            s_Writers.push_back(s_Writer);
+        }
+        s_Writer->Write(entry);
+    }
+
+} // namespace cppserv
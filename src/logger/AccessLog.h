@@ -0,0 +1,124 @@
+#ifndef __ACCESSLOG_H__
+#define __ACCESSLOG_H__
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <sys/socket.h>
+
+#include "../core/cppservcore.h"
+#include "../http/httputil.h"
+#include "AccessLogFormat.h"
+#include "../metrics/RequestTimeline.h"
+
+namespace cppserv {
+
+    struct AccessLogConfig {
+        std::string directory = "logs";
+        size_t segmentBytes = 64 * 1048576;
+        size_t maxInternedStrings = 65536;
+        bool stageTimings = false;
+    };
+
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view value) const { return std::hash<std::string_view>{}(value); }
+    };
+
+    /**
+     * \brief One served request as it is handed to the access log.
+     */
+    struct AccessLogEntry {
+        HttpMethod method = HttpMethod::NOT_IMPLEMENTED;
+        uint16_t status = 0;
+        uint32_t bytesIn = 0;
+        uint32_t bytesOut = 0;
+        uint64_t latencyNs = 0;
+        uint64_t connectionId = 0;
+        std::string_view path;
+        const struct sockaddr_storage* peer = nullptr;
+        const RequestTimeline* timeline = nullptr;
+        // 0 if not measured
+        uint64_t receiveQueueNs = 0;
+    };
+
+    /**
+     * \brief Appends binary access log records to the memory mapped segments of one worker.
+     *
+     * Nothing is formatted on the serving path: a record is a fixed 64 byte struct copied into the
+     * mapped segment, strings are interned per segment. Segments are rotated by size. Decoding to
+     * text, JSON or CSV is done offline by `cppserv-logcat`.
+     */
+    class AccessLogWriter {
+    public:
+        AccessLogWriter(const AccessLogConfig& config, uint32_t worker);
+        ~AccessLogWriter();
+
+        AccessLogWriter(const AccessLogWriter&) = delete;
+        AccessLogWriter& operator=(const AccessLogWriter&) = delete;
+
+        /**
+         * \brief Appends a request record.
+         *
+         * \param entry The request to log.
+         */
+        void Write(const AccessLogEntry& entry);
+
+        /**
+         * \brief Truncates the current segment to its used size and unmaps it.
+         */
+        void Close();
+
+    private:
+        int OpenSegment();
+        char* Reserve(uint32_t type, uint32_t payloadSize);
+        uint32_t Intern(std::string_view value);
+
+    private:
+        const AccessLogConfig& m_Config;
+        uint32_t m_Worker;
+        uint32_t m_Sequence;
+        int m_Fd;
+        char* m_Segment;
+        size_t m_Used;
+        uint32_t m_NextStringId;
+        std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<> > m_Strings;
+    };
+
+    class AccessLog {
+    public:
+        /**
+         * \brief Enables the access log.
+         *
+         * \param config The access log configuration.
+         * \return Returns 0 on success, or a negative value indicating an error.
+         */
+        static int Init(const AccessLogConfig& config);
+
+        /**
+         * \brief Closes the segments of all workers. No request may be logged afterwards.
+         *
+         * Segments are unmapped without synchronizing with their writers, so every thread that logs
+         * requests must have been joined before (the thread pool is shut down first).
+         */
+        static void Shutdown();
+
+        static bool IsEnabled() { return s_Enabled.load(std::memory_order_acquire); }
+
+        /**
+         * \brief Appends a request record to the segment of the calling worker.
+         *
+         * \param entry The request to log.
+         */
+        static void Write(const AccessLogEntry& entry);
+
+    private:
+        static std::atomic<bool> s_Enabled;
+        static AccessLogConfig s_Config;
+    };
+
+} // namespace cppserv
+
+
+#endif // __ACCESSLOG_H__
@@ -0,0 +1,89 @@
+#ifndef __ACCESSLOGFORMAT_H__
+#define __ACCESSLOGFORMAT_H__
+
+#include <stdint.h>
+
+namespace cppserv {
+
+    /**
+     * \brief On-disk layout of the binary access log.
+     *
+     * A segment file starts with an AccessLogFileHeader followed by a stream of entries. Every entry
+     * starts with an AccessLogEntryHeader and is padded to 8 bytes. Strings are interned per segment:
+     * the first time a string is used, a STRING entry assigns it an id, later REQUEST entries only
+     * store the id. Each segment is therefore self-contained. A TIMINGS entry, written only when stage
+     * timings are enabled, belongs to the REQUEST entry that follows it. Readers skip entry types they
+     * do not know. A zero entry type marks the end of the written part of a segment that was not
+     * closed cleanly.
+     *
+     * All fields are little endian.
+     */
+
+    constexpr char ACCESS_LOG_MAGIC[4] = { 'C', 'S', 'A', 'L' };
+    constexpr uint32_t ACCESS_LOG_VERSION = 1;
+
+    enum AccessLogEntryType : uint32_t {
+        ACCESS_LOG_END = 0,
+        ACCESS_LOG_STRING = 1,
+        ACCESS_LOG_REQUEST = 2,
+        ACCESS_LOG_TIMINGS = 3
+    };
+
+    /**
+     * \brief Number of stages in a TIMINGS entry: queue, first byte, read, handle, write.
+     */
+    constexpr uint32_t ACCESS_LOG_STAGES = 5;
+
+    struct AccessLogFileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t worker;
+        uint32_t sequence;
+        uint64_t createdNs;
+    };
+
+    struct AccessLogEntryHeader {
+        uint32_t type;
+        uint32_t size;
+    };
+
+    struct AccessLogString {
+        uint32_t id;
+        uint32_t length;
+        // followed by `length` bytes, not null terminated
+    };
+
+    struct AccessLogRequest {
+        uint64_t timestampNs;
+        uint64_t connectionId;
+        uint64_t latencyNs;
+        uint32_t bytesIn;
+        uint32_t bytesOut;
+        uint32_t pathId;
+        uint16_t status;
+        uint8_t method;
+        uint8_t peerFamily;
+        uint8_t peerAddress[16];
+        uint16_t peerPort;
+        uint16_t reserved[3];
+    };
+
+    struct AccessLogTimings {
+        uint32_t stageNs[ACCESS_LOG_STAGES];    // saturated at UINT32_MAX (~4.3s)
+        // kernel arrival of the first request bytes -> read returned, 0 if not measured (--rx-timestamps)
+        uint32_t receiveQueueNs;
+    };
+
+    static_assert(sizeof(AccessLogFileHeader) == 24, "access log header layout changed");
+    static_assert(sizeof(AccessLogEntryHeader) == 8, "access log entry header layout changed");
+    static_assert(sizeof(AccessLogRequest) == 64, "access log request layout changed");
+    static_assert(sizeof(AccessLogTimings) == 24, "access log timings layout changed");
+
+    constexpr uint32_t AccessLogPad(uint32_t size) {
+        return (size + 7u) & ~7u;
+    }
+
+} // namespace cppserv
+
+
+#endif // __ACCESSLOGFORMAT_H__
@@ -0,0 +1,256 @@
+#include "BackgroundRotatingSink.h"
+#include "Logger.h"
+
+#include <spdlog/sinks/base_sink-inl.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/os.h>
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <zlib.h>
+
+// from linux/ioprio.h, which is not exported by all distributions
+#define CPPSERV_IOPRIO_WHO_PROCESS 1
+#define CPPSERV_IOPRIO_CLASS_IDLE 3
+#define CPPSERV_IOPRIO_CLASS_SHIFT 13
+
+namespace cppserv {
+
+    /**
+     * \brief An archived log file found in the log directory.
+     */
+    struct LogArchive {
+        uint64_t sequence;
+        std::string path;
+        bool compressed;
+        size_t size;
+    };
+
+    /**
+     * \brief Lists the archives `<stem>.<sequence>.log[.gz]` of a log file, oldest first.
+     */
+    static std::vector<LogArchive> ListArchives(const std::string& stem, const std::string& extension) {
+        std::vector<LogArchive> archives;
+        std::string directory = spdlog::details::os::dir_name(stem);
+        std::string prefix = stem.substr(directory.empty() ? 0 : directory.size() + 1) + ".";
+
+        DIR* dir = opendir(directory.empty() ? "." : directory.c_str());
+        if (dir == nullptr) {
+            return archives;
+        }
+        while (struct dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.compare(0, prefix.size(), prefix) != 0) {
+                continue;
+            }
+            char* end = nullptr;
+            uint64_t sequence = strtoull(name.c_str() + prefix.size(), &end, 10);
+            if (end == name.c_str() + prefix.size()) {
+                continue;
+            }
+            std::string suffix = end;
+            if (suffix != extension && suffix != extension + ".gz") {
+                continue;
+            }
+            LogArchive archive;
+            archive.sequence = sequence;
+            archive.path = directory.empty() ? name : directory + "/" + name;
+            archive.compressed = suffix != extension;
+            struct stat info;
+            archive.size = stat(archive.path.c_str(), &info) == 0 ? (size_t)info.st_size : 0;
+            archives.push_back(archive);
+        }
+        closedir(dir);
+
+        std::sort(archives.begin(), archives.end(), [](const LogArchive& a, const LogArchive& b) {
+            return a.sequence < b.sequence;
+        });
+        return archives;
+    }
+
+    BackgroundRotatingSink::BackgroundRotatingSink(const BackgroundRotatingSinkConfig& config)
+        : m_Config(config), m_File(nullptr), m_Size(0), m_Sequence(0), m_Spare(nullptr), m_Stopping(false) {
+        auto [stem, extension] = spdlog::details::file_helper::split_by_extension(m_Config.path);
+        m_Stem = stem;
+        m_Extension = extension;
+        m_SparePath = m_Config.path + ".next";
+
+        spdlog::details::os::create_dir(spdlog::details::os::dir_name(m_Config.path));
+        m_File = fopen(m_Config.path.c_str(), "ab");
+        if (m_File == nullptr) {
+            throw spdlog::spdlog_ex("log file open error: " + m_Config.path, errno);
+        }
+        struct stat info;
+        m_Size = fstat(fileno(m_File), &info) == 0 ? (size_t)info.st_size : 0;
+
+        std::vector<LogArchive> archives = ListArchives(m_Stem, m_Extension);
+        m_Sequence = archives.empty() ? 1 : archives.back().sequence + 1;
+
+        m_Thread = std::thread(&BackgroundRotatingSink::Run, this);
+    }
+
+    BackgroundRotatingSink::~BackgroundRotatingSink() {
+        {
+            std::unique_lock<std::mutex> lock(m_StateMutex);
+            m_Stopping = true;
+        }
+        m_Wakeup.notify_one();
+        if (m_Thread.joinable()) {
+            m_Thread.join();
+        }
+
+        if (m_Spare != nullptr) {
+            fclose(m_Spare);
+            unlink(m_SparePath.c_str());
+        }
+        if (m_File != nullptr) {
+            fclose(m_File);
+        }
+    }
+
+    void BackgroundRotatingSink::sink_it_(const spdlog::details::log_msg& msg) {
+        spdlog::memory_buf_t formatted;
+        formatter_->format(msg, formatted);
+
+        if (m_Size + formatted.size() > m_Config.rotateBytes && m_Size > 0) {
+            std::unique_lock<std::mutex> lock(m_StateMutex);
+            // without a spare the current file grows past its limit rather than stalling the caller
+            if (m_Spare != nullptr) {
+                m_Jobs.push_back({ m_File, m_Sequence++ });
+                m_File = m_Spare;
+                m_Spare = nullptr;
+                m_Size = 0;
+                lock.unlock();
+                m_Wakeup.notify_one();
+            }
+        }
+
+        fwrite(formatted.data(), 1, formatted.size(), m_File);
+        m_Size += formatted.size();
+    }
+
+    void BackgroundRotatingSink::flush_() {
+        fflush(m_File);
+    }
+
+    void BackgroundRotatingSink::Run() {
+        setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 19);
+        syscall(SYS_ioprio_set, CPPSERV_IOPRIO_WHO_PROCESS, 0, CPPSERV_IOPRIO_CLASS_IDLE << CPPSERV_IOPRIO_CLASS_SHIFT);
+
+        OpenSpare();
+
+        // archives left uncompressed by an earlier run
+        if (m_Config.compress) {
+            for (const LogArchive& archive : ListArchives(m_Stem, m_Extension)) {
+                if (!archive.compressed) {
+                    Compress(archive.path);
+                }
+            }
+        }
+        EnforceRetention();
+
+        while (true) {
+            RotationJob job;
+            {
+                std::unique_lock<std::mutex> lock(m_StateMutex);
+                m_Wakeup.wait(lock, [this] { return m_Stopping || !m_Jobs.empty(); });
+                if (m_Jobs.empty()) {
+                    return;
+                }
+                job = m_Jobs.front();
+                m_Jobs.pop_front();
+            }
+            Finish(job);
+        }
+    }
+
+    void BackgroundRotatingSink::OpenSpare() {
+        FILE* spare = fopen(m_SparePath.c_str(), "wb");
+        if (spare == nullptr) {
+            CPPSERV_ERROR("log spare open error: {}: {}", m_SparePath, strerror(errno));
+            return;
+        }
+        std::unique_lock<std::mutex> lock(m_StateMutex);
+        m_Spare = spare;
+    }
+
+    void BackgroundRotatingSink::Finish(const RotationJob& job) {
+        fclose(job.file);
+
+        // the logging side already writes into the spare, only the names are moved here
+        std::string archive = ArchivePath(job.sequence);
+        if (rename(m_Config.path.c_str(), archive.c_str()) < 0) {
+            CPPSERV_ERROR("log rotate error: {}: {}", archive, strerror(errno));
+        }
+        if (rename(m_SparePath.c_str(), m_Config.path.c_str()) < 0) {
+            CPPSERV_ERROR("log rotate error: {}: {}", m_Config.path, strerror(errno));
+        }
+        OpenSpare();
+
+        if (m_Config.compress) {
+            Compress(archive);
+        }
+        EnforceRetention();
+    }
+
+    void BackgroundRotatingSink::Compress(const std::string& path) {
+        FILE* input = fopen(path.c_str(), "rb");
+        if (input == nullptr) {
+            CPPSERV_ERROR("log compress error: {}: {}", path, strerror(errno));
+            return;
+        }
+        std::string temporary = path + ".gz.tmp";
+        gzFile output = gzopen(temporary.c_str(), "wb6");
+        if (output == nullptr) {
+            CPPSERV_ERROR("log compress error: {}: {}", temporary, strerror(errno));
+            fclose(input);
+            return;
+        }
+
+        char buffer[65536];
+        size_t read = 0;
+        bool failed = false;
+        while ((read = fread(buffer, 1, sizeof(buffer), input)) > 0) {
+            if (gzwrite(output, buffer, (unsigned)read) != (int)read) {
+                failed = true;
+                break;
+            }
+        }
+        fclose(input);
+
+        if (gzclose(output) != Z_OK || failed) {
+            CPPSERV_ERROR("log compress error: {}", path);
+            unlink(temporary.c_str());
+            return;
+        }
+        rename(temporary.c_str(), (path + ".gz").c_str());
+        unlink(path.c_str());
+    }
+
+    void BackgroundRotatingSink::EnforceRetention() {
+        std::vector<LogArchive> archives = ListArchives(m_Stem, m_Extension);
+
+        size_t total = 0;
+        for (const LogArchive& archive : archives) {
+            total += archive.size;
+        }
+        for (const LogArchive& archive : archives) {
+            if (total <= m_Config.retainBytes) {
+                break;
+            }
+            unlink(archive.path.c_str());
+            total -= archive.size;
+        }
+    }
+
+    std::string BackgroundRotatingSink::ArchivePath(uint64_t sequence) const {
+        return m_Stem + "." + std::to_string(sequence) + m_Extension;
+    }
+
+} // namespace cppserv
@@ -0,0 +1,87 @@
+#ifndef __BACKGROUNDROTATINGSINK_H__
+#define __BACKGROUNDROTATINGSINK_H__
+
+#include <spdlog/sinks/base_sink.h>
+
+#include <cstdio>
+#include <string>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "../diagnostics/InstrumentedMutex.h"
+
+namespace cppserv {
+
+    /**
+     * \brief The mutex spdlog takes around every message of the file sink.
+     */
+    class FileSinkMutex : public InstrumentedMutex {
+    public:
+        FileSinkMutex() : InstrumentedMutex("log_file_sink") {}
+    };
+
+    struct BackgroundRotatingSinkConfig {
+        std::string path = "logs/cppserv.log";
+        size_t rotateBytes = 5 * 1048576;
+        size_t retainBytes = 64 * 1048576;
+        bool compress = true;
+    };
+
+    /**
+     * \brief File sink that keeps rotation, compression and cleanup off the logging path.
+     *
+     * A spare file (`<path>.next`) is opened ahead of time by a background thread. When the active
+     * file reaches its size limit the sink only swaps the file pointers; closing, renaming the old
+     * file to `<stem>.<sequence>.log`, gzip compression and deleting the oldest archives once their
+     * total size exceeds the retention budget all happen on the background thread, which runs at the
+     * lowest CPU and idle I/O priority. If no spare is ready yet the sink keeps writing the current
+     * file instead of waiting.
+     */
+    class BackgroundRotatingSink : public spdlog::sinks::base_sink<FileSinkMutex> {
+    public:
+        explicit BackgroundRotatingSink(const BackgroundRotatingSinkConfig& config);
+        ~BackgroundRotatingSink() override;
+
+        BackgroundRotatingSink(const BackgroundRotatingSink&) = delete;
+        BackgroundRotatingSink& operator=(const BackgroundRotatingSink&) = delete;
+
+    protected:
+        void sink_it_(const spdlog::details::log_msg& msg) override;
+        void flush_() override;
+
+    private:
+        struct RotationJob {
+            FILE* file;
+            uint64_t sequence;
+        };
+
+        void Run();
+        void OpenSpare();
+        void Finish(const RotationJob& job);
+        void Compress(const std::string& path);
+        void EnforceRetention();
+        std::string ArchivePath(uint64_t sequence) const;
+
+    private:
+        BackgroundRotatingSinkConfig m_Config;
+        std::string m_SparePath;
+        std::string m_Stem;
+        std::string m_Extension;
+        FILE* m_File;
+        size_t m_Size;
+        uint64_t m_Sequence;
+
+        std::mutex m_StateMutex;
+        std::condition_variable m_Wakeup;
+        FILE* m_Spare;
+        std::deque<RotationJob> m_Jobs;
+        bool m_Stopping;
+        std::thread m_Thread;
+
+    };
+
+} // namespace cppserv
+
+#endif // __BACKGROUNDROTATINGSINK_H__
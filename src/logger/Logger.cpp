@@ -1,28 +1,99 @@
 #include "Logger.h"
+#include "BackgroundRotatingSink.h"
 
-#include <spdlog/sinks/stdout_color_sinks.h>
-#include <spdlog/sinks/rotating_file_sink.h>
+#include <spdlog/async.h>
+#include <spdlog/sinks/ansicolor_sink.h>
+// the compiled spdlog only instantiates the console sink for its own mutex
+#include <spdlog/sinks/ansicolor_sink-inl.h>
+
+#include "../diagnostics/InstrumentedMutex.h"
 
 namespace cppserv {
 
+    /**
+     * \brief The console mutex of spdlog, shared by all console sinks, instrumented.
+     */
+    struct ConsoleSinkMutex {
+        using mutex_t = InstrumentedMutex;
+        static mutex_t& mutex() {
+            static InstrumentedMutex s_Mutex("log_console_sink");
+            return s_Mutex;
+        }
+    };
+
+    using ConsoleSink = spdlog::sinks::ansicolor_stdout_sink<ConsoleSinkMutex>;
+
 
     Ref<spdlog::logger> Logger::s_CoreLogger;
     Ref<spdlog::logger> Logger::s_FileLogger;
+    spdlog::logger* Logger::s_Core = nullptr;
+    spdlog::logger* Logger::s_File = nullptr;
+
+    static spdlog::async_overflow_policy ToSpdlogPolicy(LogOverflowPolicy policy) {
+        switch (policy) {
+        case LogOverflowPolicy::BLOCK: return spdlog::async_overflow_policy::block;
+        case LogOverflowPolicy::DROP_OLDEST: return spdlog::async_overflow_policy::overrun_oldest;
+        default: return spdlog::async_overflow_policy::discard_new;
+        }
+    }
 
-    void Logger::init() {
+    void Logger::init(const LoggerConfig& config) {
         spdlog::set_pattern("%^[%T] %n: %v%$");
-        s_CoreLogger = spdlog::stdout_color_mt("CPPSERV");
-        s_CoreLogger->set_level(spdlog::level::trace);
 
-        s_FileLogger = spdlog::rotating_logger_mt("FL_CPPSERV", "logs/cppserv.log", 1048576 * 5, 3);
+        BackgroundRotatingSinkConfig fileConfig;
+        fileConfig.path = config.file;
+        fileConfig.rotateBytes = config.rotateBytes;
+        fileConfig.retainBytes = config.retainBytes;
+        fileConfig.compress = config.compress;
+        auto fileSink = std::make_shared<BackgroundRotatingSink>(fileConfig);
+
+        if (config.mode == LogMode::ASYNC) {
+            spdlog::init_thread_pool(config.queueSize, 1);
+            spdlog::async_overflow_policy policy = ToSpdlogPolicy(config.overflowPolicy);
+
+            auto consoleSink = std::make_shared<ConsoleSink>();
+            s_CoreLogger = std::make_shared<spdlog::async_logger>("CPPSERV", consoleSink, spdlog::thread_pool(), policy);
+            spdlog::initialize_logger(s_CoreLogger);
+
+            s_FileLogger = std::make_shared<spdlog::async_logger>("FL_CPPSERV", fileSink, spdlog::thread_pool(), policy);
+            spdlog::initialize_logger(s_FileLogger);
+        } else {
+            s_CoreLogger = std::make_shared<spdlog::logger>("CPPSERV", std::make_shared<ConsoleSink>());
+            spdlog::initialize_logger(s_CoreLogger);
+            s_FileLogger = std::make_shared<spdlog::logger>("FL_CPPSERV", fileSink);
+            spdlog::initialize_logger(s_FileLogger);
+        }
+
+        s_CoreLogger->set_level(spdlog::level::trace);
         s_FileLogger->set_level(spdlog::level::trace);
+
+        s_Core = s_CoreLogger.get();
+        s_File = s_FileLogger.get();
+    }
+
+    void Logger::Shutdown() {
+        if (s_CoreLogger) {
+            s_CoreLogger->flush();
+        }
+        if (s_FileLogger) {
+            s_FileLogger->flush();
+        }
+        spdlog::shutdown();
+    }
+
+    uint64_t Logger::GetDroppedMessages() {
+        auto pool = spdlog::thread_pool();
+        if (!pool) {
+            return 0;
+        }
+        return (uint64_t)pool->overrun_counter() + (uint64_t)pool->discard_counter();
     }
 
-    Ref<spdlog::logger> Logger::GetCoreLogger() {
+    const Ref<spdlog::logger>& Logger::GetCoreLogger() {
         return Logger::s_CoreLogger;
     }
 
-    Ref<spdlog::logger> Logger::GetFileLogger() {
+    const Ref<spdlog::logger>& Logger::GetFileLogger() {
         return Logger::s_FileLogger;
     }
 
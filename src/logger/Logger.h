@@ -5,20 +5,139 @@
 
 #include <spdlog/spdlog.h>
 
+#include <atomic>
+#include <ctime>
+
+#define CPPSERV_LEVEL_TRACE 0
+#define CPPSERV_LEVEL_DEBUG 1
+#define CPPSERV_LEVEL_INFO 2
+#define CPPSERV_LEVEL_WARN 3
+#define CPPSERV_LEVEL_ERROR 4
+#define CPPSERV_LEVEL_CRITICAL 5
+#define CPPSERV_LEVEL_OFF 6
+
+// log statements below this level are compiled out, including the evaluation of their arguments
+#ifndef CPPSERV_ACTIVE_LEVEL
+    #ifdef NDEBUG
+        #define CPPSERV_ACTIVE_LEVEL CPPSERV_LEVEL_INFO
+    #else
+        #define CPPSERV_ACTIVE_LEVEL CPPSERV_LEVEL_TRACE
+    #endif
+#endif
+
 namespace cppserv
 {
     
+    enum class LogMode {
+        SYNC,
+        ASYNC
+    };
+
+    enum class LogOverflowPolicy {
+        BLOCK,
+        DROP_NEWEST,
+        DROP_OLDEST
+    };
+
+    struct LoggerConfig {
+        LogMode mode = LogMode::SYNC;
+        size_t queueSize = 8192;
+        LogOverflowPolicy overflowPolicy = LogOverflowPolicy::DROP_NEWEST;
+        std::string file = "logs/cppserv.log";
+        size_t rotateBytes = 5 * 1048576;
+        size_t retainBytes = 64 * 1048576;
+        bool compress = true;
+    };
 
     class Logger {
     public:
-        static void init();
+        /**
+         * \brief Creates the core (console) and file loggers.
+         *
+         * In asynchronous mode both loggers only format the message and enqueue it; a dedicated logging
+         * thread writes it to the sinks, so a slow terminal or disk no longer stalls request threads.
+         * When the queue is full the overflow policy decides whether the caller blocks or a message is
+         * dropped; dropped messages are counted.
+         *
+         * The queue is spdlog's `mpmc_blocking_queue`, a bounded ring behind a single std::mutex: every
+         * message takes that lock once, so producers still serialize on it, only for the copy into the
+         * ring instead of the write to the sink. It is not a per-thread lock-free queue.
+         *
+         * The file logger rotates on a background thread, see BackgroundRotatingSink.
+         *
+         * \param config The logger configuration.
+         */
+        static void init(const LoggerConfig& config = LoggerConfig());
 
-        static Ref<spdlog::logger> GetCoreLogger();
-        static Ref<spdlog::logger> GetFileLogger();
+        /**
+         * \brief Flushes all pending messages and stops the logging thread.
+         */
+        static void Shutdown();
+
+        /**
+         * \brief Returns the number of messages dropped because the async queue was full.
+         */
+        static uint64_t GetDroppedMessages();
+
+        static const Ref<spdlog::logger>& GetCoreLogger();
+        static const Ref<spdlog::logger>& GetFileLogger();
+
+        /**
+         * \brief Returns the core logger without touching the reference count, used by the log macros.
+         */
+        static spdlog::logger* GetCore() { return s_Core; }
+
+        /**
+         * \brief Returns the file logger without touching the reference count, used by the log macros.
+         */
+        static spdlog::logger* GetFile() { return s_File; }
 
     private:
         static Ref<spdlog::logger> s_CoreLogger;
         static Ref<spdlog::logger> s_FileLogger;
+        static spdlog::logger* s_Core;
+        static spdlog::logger* s_File;
+
+    };
+
+    /**
+     * \brief Lets at most a fixed number of messages per second through, one instance per call site.
+     */
+    class LogRateLimiter {
+    public:
+        explicit LogRateLimiter(uint32_t perSecond) : m_PerSecond(perSecond) {}
+
+        /**
+         * \brief Returns true if the message may be logged in the current second.
+         */
+        bool Allow() {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+            uint64_t second = (uint64_t)now.tv_sec;
+
+            // upper 32 bits: the current second, lower 32 bits: messages logged in it
+            uint64_t state = m_State.load(std::memory_order_relaxed);
+            while (true) {
+                uint64_t next = (state >> 32) == (second & 0xffffffff) ? state + 1 : (second << 32) | 1;
+                if ((next & 0xffffffff) > m_PerSecond) {
+                    m_Suppressed.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                if (m_State.compare_exchange_weak(state, next, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+        }
+
+        /**
+         * \brief Returns the number of messages that were suppressed so far.
+         */
+        uint64_t GetSuppressed() const { return m_Suppressed.load(std::memory_order_relaxed); }
+
+    private:
+        const uint32_t m_PerSecond;
+        std::atomic<uint64_t> m_State = 0;
+        std::atomic<uint64_t> m_Suppressed = 0;
 
     };
 
@@ -28,9 +147,75 @@ namespace cppserv
 
 #endif // __LOGGER_H__
 
-#define CPPSERV_TRACE(...) cppserv::Logger::GetCoreLogger()->trace(__VA_ARGS__)
-#define CPPSERV_INFO(...) cppserv::Logger::GetCoreLogger()->info(__VA_ARGS__)
-#define CPPSERV_WARN(...) cppserv::Logger::GetCoreLogger()->warn(__VA_ARGS__)
-#define CPPSERV_ERROR(...) cppserv::Logger::GetCoreLogger()->error(__VA_ARGS__)
-#define CPPSERV_CRITICAL(...) cppserv::Logger::GetCoreLogger()->critical(__VA_ARGS__)
-#define CPPSERV_LOG(...) cppserv::Logger::GetFileLogger()->trace(__VA_ARGS__)
\ No newline at end of file
+// checks the runtime level before the arguments are evaluated
+#define CPPSERV_LOG_AT(target, level, ...) \
+    do { \
+        spdlog::logger* cppservLogger = (target); \
+        if (cppservLogger != nullptr && cppservLogger->should_log(level)) { \
+            cppservLogger->log(level, __VA_ARGS__); \
+        } \
+    } while (0)
+
+// logs the first and then every n-th message of a call site
+#define CPPSERV_LOG_EVERY_N(n, statement) \
+    do { \
+        static std::atomic<uint64_t> cppservHits = 0; \
+        if (cppservHits.fetch_add(1, std::memory_order_relaxed) % (n) == 0) { \
+            statement; \
+        } \
+    } while (0)
+
+// logs at most perSecond messages of a call site per second
+#define CPPSERV_LOG_RATE_LIMITED(perSecond, statement) \
+    do { \
+        static cppserv::LogRateLimiter cppservLimiter(perSecond); \
+        if (cppservLimiter.Allow()) { \
+            statement; \
+        } \
+    } while (0)
+
+#define CPPSERV_LOG_DISABLED() do {} while (0)
+
+#if CPPSERV_ACTIVE_LEVEL <= CPPSERV_LEVEL_TRACE
+    #define CPPSERV_TRACE(...) CPPSERV_LOG_AT(cppserv::Logger::GetCore(), spdlog::level::trace, __VA_ARGS__)
+    #define CPPSERV_TRACE_EVERY_N(n, ...) CPPSERV_LOG_EVERY_N(n, CPPSERV_TRACE(__VA_ARGS__))
+    #define CPPSERV_TRACE_RATE_LIMITED(perSecond, ...) CPPSERV_LOG_RATE_LIMITED(perSecond, CPPSERV_TRACE(__VA_ARGS__))
+    #define CPPSERV_LOG(...) CPPSERV_LOG_AT(cppserv::Logger::GetFile(), spdlog::level::trace, __VA_ARGS__)
+#else
+    #define CPPSERV_TRACE(...) CPPSERV_LOG_DISABLED()
+    #define CPPSERV_TRACE_EVERY_N(n, ...) CPPSERV_LOG_DISABLED()
+    #define CPPSERV_TRACE_RATE_LIMITED(perSecond, ...) CPPSERV_LOG_DISABLED()
+    #define CPPSERV_LOG(...) CPPSERV_LOG_DISABLED()
+#endif
+
+#if CPPSERV_ACTIVE_LEVEL <= CPPSERV_LEVEL_INFO
+    #define CPPSERV_INFO(...) CPPSERV_LOG_AT(cppserv::Logger::GetCore(), spdlog::level::info, __VA_ARGS__)
+    #define CPPSERV_INFO_EVERY_N(n, ...) CPPSERV_LOG_EVERY_N(n, CPPSERV_INFO(__VA_ARGS__))
+    #define CPPSERV_INFO_RATE_LIMITED(perSecond, ...) CPPSERV_LOG_RATE_LIMITED(perSecond, CPPSERV_INFO(__VA_ARGS__))
+#else
+    #define CPPSERV_INFO(...) CPPSERV_LOG_DISABLED()
+    #define CPPSERV_INFO_EVERY_N(n, ...) CPPSERV_LOG_DISABLED()
+    #define CPPSERV_INFO_RATE_LIMITED(perSecond, ...) CPPSERV_LOG_DISABLED()
+#endif
+
+#if CPPSERV_ACTIVE_LEVEL <= CPPSERV_LEVEL_WARN
+    #define CPPSERV_WARN(...) CPPSERV_LOG_AT(cppserv::Logger::GetCore(), spdlog::level::warn, __VA_ARGS__)
+    #define CPPSERV_WARN_RATE_LIMITED(perSecond, ...) CPPSERV_LOG_RATE_LIMITED(perSecond, CPPSERV_WARN(__VA_ARGS__))
+#else
+    #define CPPSERV_WARN(...) CPPSERV_LOG_DISABLED()
+    #define CPPSERV_WARN_RATE_LIMITED(perSecond, ...) CPPSERV_LOG_DISABLED()
+#endif
+
+#if CPPSERV_ACTIVE_LEVEL <= CPPSERV_LEVEL_ERROR
+    #define CPPSERV_ERROR(...) CPPSERV_LOG_AT(cppserv::Logger::GetCore(), spdlog::level::err, __VA_ARGS__)
+    #define CPPSERV_ERROR_RATE_LIMITED(perSecond, ...) CPPSERV_LOG_RATE_LIMITED(perSecond, CPPSERV_ERROR(__VA_ARGS__))
+#else
+    #define CPPSERV_ERROR(...) CPPSERV_LOG_DISABLED()
+    #define CPPSERV_ERROR_RATE_LIMITED(perSecond, ...) CPPSERV_LOG_DISABLED()
+#endif
+
+#if CPPSERV_ACTIVE_LEVEL <= CPPSERV_LEVEL_CRITICAL
+    #define CPPSERV_CRITICAL(...) CPPSERV_LOG_AT(cppserv::Logger::GetCore(), spdlog::level::critical, __VA_ARGS__)
+#else
+    #define CPPSERV_CRITICAL(...) CPPSERV_LOG_DISABLED()
+#endif
@@ -4,14 +4,41 @@
 #include <cstring>
 
 #include "socket/Socket.h"
+#include "socket/DatagramServer.h"
+#include "tls/TlsConnection.h"
+#include "coro/AsyncConnection.h"
 #include "logger/Logger.h"
+#include "logger/AccessLog.h"
 #include "threadpool/Threadpool.h"
 
 #include "core/cppservcore.h"
 #include "http/httprequest.h"
+#include "http/httpparser.h"
+#include "http/HttpPipeline.h"
+#include "transport/SocketTransport.h"
+#include "memory/RequestArena.h"
+#include "connection/ConnectionPool.h"
+#include "connection/TcpInfoSampler.h"
+#include "memory/BufferPool.h"
+#include "diagnostics/FlightRecorder.h"
+#include "diagnostics/SamplingProfiler.h"
+#include "diagnostics/InstrumentedMutex.h"
+#include "admin/AdminRegistry.h"
+#include "admin/AdminServer.h"
+#include "capture/TrafficCapture.h"
+#include "metrics/MetricsRegistry.h"
+#include "metrics/HardwareCounters.h"
+
+#include <optional>
+#include <chrono>
+#include <memory_resource>
 
 #define SERVER_RUNNING 1
 #define SERVER_STOP 0
+#define MAX_CONNECTIONS 65536
+#define IO_BUFFER_SIZE 16384
+// the tail of a --coroutines connection's I/O buffer that holds its parsed request
+#define CORO_REQUEST_MEMORY 4096
 
 
 /**
@@ -20,9 +47,322 @@
 static volatile int s_Running = SERVER_STOP;
 
 
+/**
+ * @brief The pool all accepted connections of the thread pool server are taken from.
+ */
+static cppserv::ConnectionPool s_Connections;
+
+
+/**
+ * @brief The id of the next connection of the --coroutines server, only used on the event loop thread.
+ */
+static uint64_t s_NextCoroutineConnectionId = 1;
+
+
+/**
+ * @brief Samples TCP_INFO of the open connections, only with --tcp-info-ms.
+ */
+static cppserv::TcpInfoSampler s_TcpInfo;
+
+
+/**
+ * @brief The worker threads of the thread pool server.
+ */
+static cppserv::ThreadPool s_ThreadPool;
+
+
+/**
+ * @brief The TLS context of the listener, empty for plaintext.
+ */
+static std::unique_ptr<cppserv::TlsContext> s_TlsContext;
+
+
+/**
+ * @brief Reads the kernel receive timestamp of the first bytes of every plaintext request.
+ */
+static bool s_ReceiveTimestamps = false;
+
+
+/**
+ * @brief The number of bytes of each request that is logged, 0 disables request logging.
+ */
+static size_t s_LogRequestBytes = 0;
+
+
+/**
+ * @brief The metrics of one route.
+ */
+struct RouteMetrics {
+    cppserv::Histogram* duration = nullptr;
+    // only registered with --hw-counters
+    cppserv::HardwareStageCounters hardware;
+};
+
+
+/**
+ * @brief The metrics the request path updates, registered by init_metrics.
+ */
+struct ServerMetrics {
+    cppserv::Counter* accepts = nullptr;
+    cppserv::Counter* bytesIn = nullptr;
+    cppserv::Counter* bytesOut = nullptr;
+    cppserv::Counter* requestsOk = nullptr;
+    cppserv::Counter* requestsBad = nullptr;
+    cppserv::Counter* requestsTooLarge = nullptr;
+    cppserv::Gauge* inFlight = nullptr;
+    cppserv::Histogram* stages[cppserv::STAGE_COUNT] = {};
+    // only with --rx-timestamps
+    cppserv::Histogram* receiveQueue = nullptr;
+    cppserv::Histogram* kernelToWritten = nullptr;
+    RouteMetrics defaultRoute;
+    // only with --payload-kb
+    RouteMetrics payloadRoute;
+};
+static ServerMetrics s_Metrics;
+
+
+/**
+ * @brief The response that is sent for every request.
+ */
+static const std::string s_Response = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: 12\r\n\r\nHello World!";
+/**
+ * @brief The response for /payload, a body of `--payload-kb` kilobytes to measure large responses.
+ */
+static std::string s_Payload;
+
+/**
+ * @brief The command line options of the server.
+ */
+struct ServerOptions {
+    std::string port = "8080";
+    std::string udpPort = "";
+    size_t udpShards = std::thread::hardware_concurrency();
+    size_t udpBatch = 64;
+    size_t threads = std::thread::hardware_concurrency();
+    bool pin = false;
+    size_t payloadKb = 0;
+    std::string tlsCertificate = "";
+    std::string tlsPrivateKey = "";
+    bool ktls = true;
+    bool coroutines = false;
+    size_t ioMemoryMb = 256;
+    bool hugePages = false;
+    std::string adminPort = "";
+    std::string adminHost = "127.0.0.1";
+    size_t logRequestBytes = 0;
+    std::string accessLog = "";
+    size_t accessLogSegmentMb = 64;
+    bool accessLogTimings = false;
+    std::string capture = "";
+    size_t captureMb = 1024;
+    bool captureRedact = true;
+    bool hardwareCounters = false;
+    bool receiveTimestamps = false;
+    unsigned tcpInfoMs = 0;
+    cppserv::LoggerConfig logger;
+};
+
+
 /**
  * @brief Prints the usage of the server program and exits with status code EXIT_FAILURE.
  *
+ * @param program the name of the program
+ */
+void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+        << "  --port <port>        TCP port of the HTTP server (default 8080)\n"
+        << "  --udp-port <port>    enable the datagram server on this port\n"
+        << "  --udp-shards <n>     number of SO_REUSEPORT sockets/threads (default: cores)\n"
+        << "  --udp-batch <n>      datagrams per recvmmsg/sendmmsg call (default 64)\n"
+        << "  --threads <n>        worker threads of the HTTP server (default: cores)\n"
+        << "  --pin                pin worker thread i to CPU i\n"
+        << "  --payload-kb <n>     serve a response with a body of n KB under /payload\n"
+        << "  --tls-cert <file>    serve HTTPS with this PEM certificate chain\n"
+        << "  --tls-key <file>     PEM private key of the certificate\n"
+        << "  --no-ktls            keep TLS record encryption in user space\n"
+        << "  --coroutines         serve plaintext HTTP from a single event loop thread\n"
+        << "  --io-memory-mb <n>   hard cap of the I/O buffer pool in MB (default 256)\n"
+        << "  --huge-pages         back the I/O buffer pool with 2MB huge pages\n"
+        << "  --async-log          write log messages from a dedicated logging thread\n"
+        << "  --log-queue <n>      capacity of the async log queue (default 8192)\n"
+        << "  --log-overflow <p>   full async queue: block, drop (default) or drop-oldest\n"
+        << "  --admin-port <port>  serve diagnostics under /admin/ (flight recorder, profile...) on this port\n"
+        << "  --admin-host <ip>    address of the admin listener (default 127.0.0.1)\n"
+        << "  --log-file <file>    file of the file logger (default logs/cppserv.log)\n"
+        << "  --log-rotate-mb <n>  rotate the log file at this size in MB (default 5)\n"
+        << "  --log-retain-mb <n>  keep at most this many MB of rotated logs (default 64)\n"
+        << "  --no-log-compress    keep rotated logs uncompressed\n"
+        << "  --log-requests <n>   log the first n bytes of every request (default 0: off)\n"
+        << "  --access-log <dir>   write a binary access log per worker into this directory\n"
+        << "  --access-log-segment-mb <n>  size of the access log segments in MB (default 64)\n"
+        << "  --access-log-timings record the per-stage latency of every request in the access log\n"
+        << "  --capture <file>     record incoming requests for replay with cppserv-loadgen --replay\n"
+        << "  --capture-mb <n>     stop capturing at this file size in MB (default 1024)\n"
+        << "  --capture-no-redact  keep credential headers (Authorization, Cookie...) in the capture\n"
+        << "  --hw-counters        count cycles, instructions, cache and branch misses per stage and route\n"
+        << "  --rx-timestamps      measure from kernel arrival of the request (SO_TIMESTAMPING, plaintext only)\n"
+        << "  --tcp-info-ms <n>    sample RTT, retransmits and cwnd of open connections every n ms (default 0: off)\n";
+    exit(EXIT_FAILURE);
+}
+
+
+/**
+ * @brief Parses the command line options.
+ *
+ * @param argc the argument count
+ * @param argv the arguments
+ * @return the parsed options
+ */
+ServerOptions parse_options(int argc, char* argv[]) {
+    ServerOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+            }
+            return argv[++i];
+        };
+        if (arg == "--port") {
+            options.port = value();
+        } else if (arg == "--udp-port") {
+            options.udpPort = value();
+        } else if (arg == "--udp-shards") {
+            options.udpShards = std::stoul(value());
+        } else if (arg == "--udp-batch") {
+            options.udpBatch = std::stoul(value());
+            if (options.udpBatch == 0) {
+                usage(argv[0]);
+            }
+        } else if (arg == "--threads") {
+            options.threads = std::stoul(value());
+        } else if (arg == "--pin") {
+            options.pin = true;
+        } else if (arg == "--payload-kb") {
+            options.payloadKb = std::stoul(value());
+        } else if (arg == "--tls-cert") {
+            options.tlsCertificate = value();
+        } else if (arg == "--tls-key") {
+            options.tlsPrivateKey = value();
+        } else if (arg == "--no-ktls") {
+            options.ktls = false;
+        } else if (arg == "--coroutines") {
+            options.coroutines = true;
+        } else if (arg == "--io-memory-mb") {
+            options.ioMemoryMb = std::stoul(value());
+        } else if (arg == "--huge-pages") {
+            options.hugePages = true;
+        } else if (arg == "--async-log") {
+            options.logger.mode = cppserv::LogMode::ASYNC;
+        } else if (arg == "--log-queue") {
+            options.logger.queueSize = std::stoul(value());
+        } else if (arg == "--log-overflow") {
+            std::string policy = value();
+            if (policy == "block") {
+                options.logger.overflowPolicy = cppserv::LogOverflowPolicy::BLOCK;
+            } else if (policy == "drop") {
+                options.logger.overflowPolicy = cppserv::LogOverflowPolicy::DROP_NEWEST;
+            } else if (policy == "drop-oldest") {
+                options.logger.overflowPolicy = cppserv::LogOverflowPolicy::DROP_OLDEST;
+            } else {
+                usage(argv[0]);
+            }
+        } else if (arg == "--admin-port") {
+            options.adminPort = value();
+        } else if (arg == "--admin-host") {
+            options.adminHost = value();
+        } else if (arg == "--log-file") {
+            options.logger.file = value();
+        } else if (arg == "--log-rotate-mb") {
+            options.logger.rotateBytes = std::stoul(value()) * 1048576;
+        } else if (arg == "--log-retain-mb") {
+            options.logger.retainBytes = std::stoul(value()) * 1048576;
+        } else if (arg == "--no-log-compress") {
+            options.logger.compress = false;
+        } else if (arg == "--log-requests") {
+            options.logRequestBytes = std::stoul(value());
+        } else if (arg == "--access-log") {
+            options.accessLog = value();
+        } else if (arg == "--access-log-segment-mb") {
+            options.accessLogSegmentMb = std::stoul(value());
+        } else if (arg == "--access-log-timings") {
+            options.accessLogTimings = true;
+        } else if (arg == "--capture") {
+            options.capture = value();
+        } else if (arg == "--capture-mb") {
+            options.captureMb = std::stoul(value());
+        } else if (arg == "--capture-no-redact") {
+            options.captureRedact = false;
+        } else if (arg == "--hw-counters") {
+            options.hardwareCounters = true;
+        } else if (arg == "--rx-timestamps") {
+            options.receiveTimestamps = true;
+        } else if (arg == "--tcp-info-ms") {
+            options.tcpInfoMs = std::stoul(value());
+        } else {
+            usage(argv[0]);
+        }
+    }
+    return options;
+}
+
+
+/**
+ * @brief Registers the server metrics and, with --admin-port, the /metrics endpoint of the admin listener.
+ *
+ * @param options the command line options, they decide which routes exist
+ */
+void init_metrics(const ServerOptions& options) {
+    cppserv::MetricsRegistry& registry = cppserv::MetricsRegistry::Get();
+    s_Metrics.accepts = &registry.AddCounter("cppserv_accepts_total", "Accepted TCP connections.");
+    registry.AddGaugeFunction("cppserv_active_connections", "Connections that are open.",
+        [] { return (double)s_Connections.GetActive(); });
+    s_Metrics.inFlight = &registry.AddGauge("cppserv_requests_in_flight", "Requests that are being read or answered.");
+    s_Metrics.bytesIn = &registry.AddCounter("cppserv_received_bytes_total", "Bytes received from clients.");
+    s_Metrics.bytesOut = &registry.AddCounter("cppserv_sent_bytes_total", "Bytes sent to clients.");
+    s_Metrics.requestsOk = &registry.AddCounter("cppserv_requests_total", "Answered requests by status.", "status=\"200\"");
+    s_Metrics.requestsBad = &registry.AddCounter("cppserv_requests_total", "Answered requests by status.", "status=\"400\"");
+    s_Metrics.requestsTooLarge = &registry.AddCounter("cppserv_requests_total", "Answered requests by status.", "status=\"413\"");
+    registry.AddGaugeFunction("cppserv_threadpool_queue_depth", "Connections waiting for a worker thread.",
+        [] { return (double)s_ThreadPool.GetQueueDepth(); });
+    s_ThreadPool.SetWaitTimeHistogram(&registry.AddHistogram("cppserv_threadpool_wait_seconds", "Time tasks waited for a worker thread."));
+
+    const std::string stageHelp = "Time spent per request stage.";
+    for (int stage = 0; stage < cppserv::STAGE_COUNT; stage++) {
+        std::string label = std::string("stage=\"") + cppserv::RequestStageToString((cppserv::RequestStage)stage) + "\"";
+        s_Metrics.stages[stage] = &registry.AddHistogram("cppserv_stage_duration_seconds", stageHelp, label);
+    }
+
+    if (s_ReceiveTimestamps) {
+        s_Metrics.receiveQueue = &registry.AddHistogram("cppserv_receive_queue_seconds",
+            "Time the first request bytes waited in the socket receive queue, from kernel arrival to the read.");
+        s_Metrics.kernelToWritten = &registry.AddHistogram("cppserv_kernel_to_written_seconds",
+            "Time from kernel arrival of the first request bytes to the last byte of the response.");
+    }
+
+    const std::string routeHelp = "Time from accepting a connection to the last byte of the response, per route.";
+    auto addRoute = [&registry, &routeHelp](RouteMetrics& route, const std::string& label) {
+        route.duration = &registry.AddHistogram("cppserv_request_duration_seconds", routeHelp, label);
+        if (cppserv::HardwareCounters::IsEnabled()) {
+            route.hardware.Register(registry, label);
+        }
+    };
+    addRoute(s_Metrics.defaultRoute, "route=\"default\"");
+    if (options.payloadKb > 0) {
+        addRoute(s_Metrics.payloadRoute, "route=\"/payload\"");
+    }
+    // scraped on the admin listener only, never on the public port
+    if (!options.adminPort.empty()) {
+        cppserv::AdminRegistry::Register("/metrics", [] {
+            return cppserv::MetricsRegistry::Get().Render();
+        });
+    }
+}
+
+
+/**
+ * @brief Stops the server on SIGINT and SIGTERM.
+ *
  * @param signal the signal
  */
 void handle_signal(int signal) {
@@ -33,55 +373,516 @@ void handle_signal(int signal) {
 }
 
 
+/**
+ * @brief Selects the response of a parsed request.
+ *
+ * @param exchange the exchange the request was parsed from
+ * @param request the parsed request
+ * @return the response for /payload when `--payload-kb` is set, otherwise nullptr for the default response
+ */
+const std::string* route_request(const cppserv::HttpExchange& exchange, const cppserv::HttpRequest& request) {
+    if (s_LogRequestBytes > 0) {
+        size_t logged = std::min(exchange.buffered, s_LogRequestBytes);
+        CPPSERV_INFO("Received request: {0}{1}", std::string_view(exchange.buffer, logged),
+            logged < exchange.buffered ? " [truncated]" : "");
+    }
+    if (!s_Payload.empty() && request.GetPath() == "/payload") {
+        return &s_Payload;
+    }
+    return nullptr;
+}
+
+
+/**
+ * @brief Records a served request: traffic capture, metrics and access log.
+ *
+ * @param exchange the finished exchange
+ * @param slot the slot of the connection, identifies it in the traffic capture
+ * @param peer the address of the client
+ * @param socketTransport the transport the request was read from if it may carry receive timestamps, or nullptr
+ */
+void record_request(const cppserv::HttpExchange& exchange, uint32_t slot, const struct sockaddr_storage& peer,
+    const cppserv::SocketTransport* socketTransport) {
+    const cppserv::RequestTimeline& timeline = *exchange.timeline;
+    const cppserv::HttpRequest& request = *exchange.request;
+    const std::string* response = exchange.response;
+
+    if (cppserv::TrafficCapture::IsEnabled() && exchange.buffered > 0) {
+        size_t length = exchange.parsed > 0 ? (size_t)exchange.parsed : exchange.buffered;
+        cppserv::TrafficCapture::Record(exchange.connectionId, slot, timeline.timestamps[cppserv::TIMESTAMP_FIRST_BYTE],
+            std::string_view(exchange.buffer, length));
+    }
+
+    RouteMetrics* route = &s_Metrics.defaultRoute;
+    if (exchange.status == 200) {
+        s_Metrics.requestsOk->Increment();
+        if (response == &s_Payload) {
+            route = &s_Metrics.payloadRoute;
+        }
+    } else if (exchange.status == 400) {
+        s_Metrics.requestsBad->Increment();
+    } else if (exchange.status == 413) {
+        s_Metrics.requestsTooLarge->Increment();
+    }
+
+    bool hasReceiveQueue = socketTransport != nullptr && socketTransport->HasReceiveQueue();
+    uint64_t receiveQueue = socketTransport != nullptr ? socketTransport->GetReceiveQueueNs() : 0;
+    s_Metrics.bytesIn->Increment(exchange.buffered);
+    if (response != nullptr) {
+        s_Metrics.bytesOut->Increment(response->size());
+        for (int stage = 0; stage < cppserv::STAGE_COUNT; stage++) {
+            s_Metrics.stages[stage]->Record(timeline.StageNanoseconds((cppserv::RequestStage)stage));
+        }
+        route->duration->Record(timeline.TotalNanoseconds());
+        if (hasReceiveQueue) {
+            s_Metrics.receiveQueue->Record(receiveQueue);
+            s_Metrics.kernelToWritten->Record(receiveQueue + cppserv::TscClock::Between(
+                timeline.timestamps[cppserv::TIMESTAMP_FIRST_BYTE], timeline.timestamps[cppserv::TIMESTAMP_WRITTEN]));
+        }
+        if (exchange.counters != nullptr) {
+            route->hardware.Record(*exchange.counters);
+        }
+    }
+
+    if (cppserv::AccessLog::IsEnabled() && response != nullptr) {
+        cppserv::AccessLogEntry entry;
+        entry.method = request.GetMethod();
+        entry.status = exchange.status;
+        entry.bytesIn = (uint32_t)exchange.buffered;
+        entry.bytesOut = (uint32_t)response->size();
+        entry.latencyNs = timeline.TotalNanoseconds();
+        entry.timeline = &timeline;
+        entry.connectionId = exchange.connectionId;
+        entry.path = request.GetPath();
+        entry.peer = &peer;
+        entry.receiveQueueNs = receiveQueue;
+        cppserv::AccessLog::Write(entry);
+    }
+}
+
+
+void handle_connection(cppserv::ConnectionHandle handle);
+
+
+/**
+ * @brief Hands a connection to the thread pool.
+ *
+ * @param handle the handle of the connection
+ */
+void submit_connection(cppserv::ConnectionHandle handle) {
+    s_ThreadPool.Submit([handle] {
+        handle_connection(handle);
+    });
+}
+
+
+/**
+ * @brief Resumes parked connections while the buffer pool has free buffers.
+ */
+void resume_parked() {
+    cppserv::ConnectionHandle handle;
+    while (cppserv::BufferPool::Get().HasFree() && s_Connections.Unpark(handle)) {
+        submit_connection(handle);
+    }
+}
+
+
+/**
+ * @brief Reads a request from an accepted connection and answers it.
+ *
+ * The request is received into a buffer borrowed from the BufferPool. When the pool is exhausted the
+ * connection is parked until a buffer is released. The parsed request and any handler scratch memory
+ * come from the worker's RequestArena, which is reset once the response is written.
+ *
+ * @param handle the handle of the accepted connection
+ */
+void handle_connection(cppserv::ConnectionHandle handle) {
+    cppserv::Connection* connection = s_Connections.Get(handle);
+    if (connection == nullptr) {
+        return;
+    }
+
+    if (!connection->AcquireBuffer()) {
+        cppserv::FlightRecorder::Record(connection->GetId(), cppserv::FlightStage::PARKED);
+        s_Connections.Park(handle);
+        // a buffer may have been released before the connection was parked
+        resume_parked();
+        return;
+    }
+    CPPSERV_TRACE("Accepted connection");
+    cppserv::RequestTimeline& timeline = connection->GetTimeline();
+    timeline.Mark(cppserv::TIMESTAMP_DEQUEUED);
+    // the first_byte stage includes the TLS handshake, count it from here
+    cppserv::HardwareTimeline hardware;
+    hardware.Mark(cppserv::TIMESTAMP_DEQUEUED);
+    uint64_t connectionId = connection->GetId();
+    cppserv::FlightRecorder::Record(connectionId, cppserv::FlightStage::ACCEPT);
+
+    std::optional<cppserv::TlsConnection> tls;
+    if (s_TlsContext) {
+        tls.emplace(*s_TlsContext, connection->GetSocket());
+        int handshake = tls->Handshake(cppserv::HTTP_READ_TIMEOUT);
+        cppserv::FlightRecorder::Record(connectionId, cppserv::FlightStage::TLS_HANDSHAKE, cppserv::HttpMethod::NOT_IMPLEMENTED, 0, handshake < 0);
+        if (handshake < 0) {
+            tls.reset();
+            cppserv::FlightRecorder::Record(connectionId, cppserv::FlightStage::CLOSE);
+            s_Connections.Release(connection);
+            return;
+        }
+    }
+    s_Metrics.inFlight->Increment();
+
+    cppserv::RequestArena& arena = cppserv::RequestArena::ForThread();
+    arena.Begin();
+    {
+        cppserv::HttpRequest request(arena.GetResource());
+        cppserv::HttpExchange exchange;
+        exchange.buffer = connection->GetBuffer();
+        exchange.capacity = connection->GetBuffered() + connection->GetBufferSpace();
+        exchange.buffered = connection->GetBuffered();
+        exchange.request = &request;
+        exchange.timeline = &timeline;
+        exchange.connectionId = connectionId;
+        if (cppserv::HardwareCounters::IsEnabled()) {
+            exchange.counters = &hardware;
+        }
+
+        cppserv::SocketTransport socketTransport(connection->GetSocket(), s_ReceiveTimestamps && !tls);
+        cppserv::Transport& transport = tls ? static_cast<cppserv::Transport&>(*tls) : socketTransport;
+
+        cppserv::HttpPipeline::Serve(transport, exchange, [&exchange](const cppserv::HttpRequest& request) {
+            return route_request(exchange, request);
+        }, s_Response);
+        connection->Commit(exchange.buffered - connection->GetBuffered());
+        record_request(exchange, handle.index, connection->GetPeer(), &socketTransport);
+    }
+    arena.Reset();
+    CPPSERV_TRACE("Request made {} heap allocations", arena.GetLastHeapAllocations());
+    s_Metrics.inFlight->Decrement();
+
+    if (tls) {
+        tls->Shutdown();
+        tls.reset();
+    }
+    cppserv::FlightRecorder::Record(connectionId, cppserv::FlightStage::CLOSE);
+    s_Connections.Release(connection);
+}
+
+
+/**
+ * @brief Coroutine version of handle_connection, suspends instead of blocking while waiting for the peer.
+ *
+ * The request runs through the same HttpPipeline stages, metrics and access log as in handle_connection.
+ * It is read into a buffer of the BufferPool whose last CORO_REQUEST_MEMORY bytes back the parsed request,
+ * because the RequestArena of the thread is shared by all connections of the loop and cannot be held
+ * across a suspension. A peer that sends nothing for HTTP_READ_TIMEOUT seconds is disconnected.
+ *
+ * @param loop the event loop that drives the connection
+ * @param clientSocket the accepted connection
+ * @param peer the address of the client
+ * @param accepted the TscClock reading when the connection was accepted
+ */
+cppserv::Task<void> serve_connection(cppserv::EventLoop& loop, cppserv::Socket clientSocket, struct sockaddr_storage peer,
+    uint64_t accepted) {
+    cppserv::AsyncConnection conn(loop, clientSocket);
+    uint64_t connectionId = s_NextCoroutineConnectionId++;
+
+    cppserv::BufferPool& pool = cppserv::BufferPool::Get();
+    char* buffer = pool.Acquire();
+    while (buffer == nullptr && s_Running == SERVER_RUNNING) {
+        // the memory cap is reached, wait for other connections to release their buffers
+        co_await loop.SleepFor(std::chrono::milliseconds(10));
+        buffer = pool.Acquire();
+    }
+    if (buffer == nullptr) {
+        conn.Close();
+        co_return;
+    }
+
+    cppserv::RequestTimeline timeline;
+    timeline.timestamps[cppserv::TIMESTAMP_ACCEPTED] = accepted;
+    timeline.Mark(cppserv::TIMESTAMP_DEQUEUED);
+    cppserv::FlightRecorder::Record(connectionId, cppserv::FlightStage::ACCEPT);
+    s_Metrics.inFlight->Increment();
+    {
+        std::pmr::monotonic_buffer_resource requestMemory(buffer + IO_BUFFER_SIZE - CORO_REQUEST_MEMORY, CORO_REQUEST_MEMORY);
+        cppserv::HttpRequest request(&requestMemory);
+        cppserv::HttpExchange exchange;
+        exchange.buffer = buffer;
+        exchange.capacity = IO_BUFFER_SIZE - CORO_REQUEST_MEMORY;
+        exchange.request = &request;
+        exchange.timeline = &timeline;
+        exchange.connectionId = connectionId;
+
+        bool complete = cppserv::HttpPipeline::Parse(exchange);
+        while (!complete) {
+            auto deadline = cppserv::EventLoop::Clock::now() + std::chrono::seconds(cppserv::HTTP_READ_TIMEOUT);
+            int received = co_await conn.Read(exchange.buffer + exchange.buffered, exchange.capacity - exchange.buffered, deadline);
+            if (received <= 0) {
+                break;
+            }
+            complete = cppserv::HttpPipeline::Received(exchange, (size_t)received);
+        }
+
+        const std::string* response = cppserv::HttpPipeline::Route(exchange, [&exchange](const cppserv::HttpRequest& request) {
+            return route_request(exchange, request);
+        }, s_Response);
+        if (response != nullptr) {
+            co_await conn.Write(response->data(), response->size());
+        }
+        cppserv::HttpPipeline::Written(exchange);
+        record_request(exchange, (uint32_t)conn.GetSocket().GetHandle(), peer, nullptr);
+    }
+    s_Metrics.inFlight->Decrement();
+
+    pool.Release(buffer);
+    cppserv::FlightRecorder::Record(connectionId, cppserv::FlightStage::CLOSE);
+    conn.Close();
+}
+
+
+/**
+ * @brief Accepts connections on the event loop and spawns a serve_connection task for each of them.
+ *
+ * @param loop the event loop
+ * @param socket the listening socket
+ */
+cppserv::Task<void> accept_connections(cppserv::EventLoop& loop, cppserv::Socket& socket) {
+    cppserv::AsyncListener listener(loop, socket);
+    while (s_Running == SERVER_RUNNING) {
+        struct sockaddr_storage peer;
+        socklen_t peerLen;
+        int handle = co_await listener.Accept(peer, peerLen);
+        if (handle < 0) {
+            // e.g. EMFILE: the connection stays pending and retrying at once would spin the loop
+            co_await loop.SleepFor(std::chrono::milliseconds(50));
+            continue;
+        }
+        uint64_t accepted = cppserv::TscClock::Now();
+        s_Metrics.accepts->Increment();
+        loop.Spawn(serve_connection(loop, cppserv::Socket(handle), peer, accepted));
+    }
+}
+
+
+/**
+ * @brief Stops the event loop once the server is asked to stop.
+ *
+ * @param loop the event loop
+ */
+cppserv::Task<void> watch_running(cppserv::EventLoop& loop) {
+    while (s_Running == SERVER_RUNNING) {
+        co_await loop.SleepFor(std::chrono::milliseconds(200));
+    }
+    loop.Stop();
+}
+
+
 int main(int argc, char* argv[]) {
 
-    cppserv::Logger::init();
+    ServerOptions options = parse_options(argc, argv);
+
+    cppserv::Logger::init(options.logger);
+    s_LogRequestBytes = options.logRequestBytes;
+    cppserv::TscClock::Calibrate();
 
     struct sigaction signal_handler;
     memset(&signal_handler, 0, sizeof(signal_handler));
     signal_handler.sa_handler = handle_signal;
     sigaction(SIGINT, &signal_handler, nullptr);
     sigaction(SIGTERM, &signal_handler, nullptr);
+    // a peer closing early must not kill the process in send()
+    signal(SIGPIPE, SIG_IGN);
+    cppserv::FlightRecorder::Init();
+
+    if (!options.adminPort.empty()) {
+        cppserv::AdminRegistry::Register("/admin/flight-recorder", [] {
+            return cppserv::FlightRecorder::DumpText();
+        });
+        cppserv::AdminRegistry::Register("/admin/locks", [] {
+            return cppserv::InstrumentedMutex::Report();
+        });
+        cppserv::AdminRegistry::Register("/admin/connections", [] {
+            return cppserv::TcpInfoSampler::Report(s_Connections);
+        });
+        cppserv::AdminRegistry::Register("/admin/profile", [](std::string_view query) {
+            return cppserv::SamplingProfiler::HandleAdmin(query);
+        });
+        // the accept loop and the event loop of --coroutines run on the main thread
+        cppserv::SamplingProfiler::RegisterThread("main");
+        s_ThreadPool.SetThreadStartHook([](size_t) {
+            cppserv::SamplingProfiler::RegisterThread("worker");
+        });
+    }
+    if (options.hardwareCounters) {
+        cppserv::HardwareCounters::Enable();
+    }
+    s_ReceiveTimestamps = options.receiveTimestamps && options.tlsCertificate.empty() && !options.coroutines;
+    if (options.receiveTimestamps && !s_ReceiveTimestamps) {
+        CPPSERV_WARN("--rx-timestamps only applies to the plaintext thread pool server");
+    }
+    if (options.tcpInfoMs > 0 && options.coroutines) {
+        CPPSERV_WARN("--tcp-info-ms only applies to the thread pool server");
+    }
+    init_metrics(options);
+
+    cppserv::AdminServer adminServer;
+    if (!options.adminPort.empty()) {
+        cppserv::AdminServerConfig adminConfig;
+        adminConfig.host = options.adminHost;
+        adminConfig.port = options.adminPort;
+        if (adminServer.Init(adminConfig) < 0) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!options.tlsCertificate.empty()) {
+        cppserv::TlsConfig tlsConfig;
+        tlsConfig.certificateFile = options.tlsCertificate;
+        tlsConfig.privateKeyFile = options.tlsPrivateKey.empty() ? options.tlsCertificate : options.tlsPrivateKey;
+        tlsConfig.enableKtls = options.ktls;
+        s_TlsContext = std::make_unique<cppserv::TlsContext>();
+        if (s_TlsContext->Init(tlsConfig) < 0) {
+            return EXIT_FAILURE;
+        }
+    }
 
     cppserv::Socket socket(AF_INET, SOCK_STREAM, 0);
 
-    socket.Bind("0.0.0.0", "8080");
+    // connections the server closed linger in TIME_WAIT, a restarted server must still be able to bind
+    int reuseAddress = 1;
+    socket.SocketSetOpt(SOL_SOCKET, SO_REUSEADDR, &reuseAddress);
+    // accepted sockets inherit the option
+    if (s_ReceiveTimestamps && socket.EnableReceiveTimestamps() < 0) {
+        s_ReceiveTimestamps = false;
+    }
+    socket.Bind("0.0.0.0", options.port);
     socket.Listen(20);
 
     s_Running = SERVER_RUNNING;
 
-    cppserv::ThreadPool threadpool;
-    threadpool.Init();
+    if (!options.accessLog.empty()) {
+        cppserv::AccessLogConfig accessLogConfig;
+        accessLogConfig.directory = options.accessLog;
+        accessLogConfig.segmentBytes = options.accessLogSegmentMb * 1048576;
+        accessLogConfig.stageTimings = options.accessLogTimings;
+        if (cppserv::AccessLog::Init(accessLogConfig) < 0) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!options.capture.empty()) {
+        if (!options.captureRedact) {
+            cppserv::TrafficCapture::SetRedactor(nullptr);
+        }
+        cppserv::TrafficCaptureConfig captureConfig;
+        captureConfig.path = options.capture;
+        captureConfig.maxBytes = options.captureMb * 1048576;
+        if (cppserv::TrafficCapture::Init(captureConfig) < 0) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    cppserv::BufferPoolConfig bufferConfig;
+    bufferConfig.bufferSize = IO_BUFFER_SIZE;
+    bufferConfig.maxBytes = options.ioMemoryMb * 1048576;
+    bufferConfig.hugePages = options.hugePages;
+    if (cppserv::BufferPool::Get().Init(bufferConfig) < 0) {
+        return EXIT_FAILURE;
+    }
 
+    if (options.payloadKb > 0) {
+        s_Payload = "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nContent-Length: "
+            + std::to_string(options.payloadKb * 1024) + "\r\n\r\n" + std::string(options.payloadKb * 1024, 'x');
+    }
+
+    if (options.coroutines) {
+        cppserv::EventLoop loop;
+        if (loop.Init() < 0) {
+            return EXIT_FAILURE;
+        }
+        loop.Spawn(watch_running(loop));
+        loop.Spawn(accept_connections(loop, socket));
+        loop.Run();
+        adminServer.Shutdown();
+        socket.Close();
+        cppserv::AccessLog::Shutdown();
+        cppserv::TrafficCapture::Shutdown();
+        cppserv::Logger::Shutdown();
+        return EXIT_SUCCESS;
+    }
+
+    cppserv::BufferPool::Get().SetAvailableCallback(resume_parked);
+
+    cppserv::DatagramServer datagramServer;
+    if (!options.udpPort.empty()) {
+        cppserv::DatagramServerConfig datagramConfig;
+        datagramConfig.port = options.udpPort;
+        datagramConfig.shards = options.udpShards;
+        datagramConfig.batchSize = options.udpBatch;
+        // telemetry ingestion: datagrams are consumed, nothing is sent back
+        if (datagramServer.Init(datagramConfig, [](cppserv::DatagramBatch&, cppserv::DatagramBatch&) {}) < 0) {
+            return EXIT_FAILURE;
+        }
+    }
 
+    s_ThreadPool.Init(std::max<size_t>(options.threads, 1), options.pin);
+
+    s_Connections.Init(MAX_CONNECTIONS);
+    if (options.tcpInfoMs > 0 && s_TcpInfo.Init(s_Connections, options.tcpInfoMs) < 0) {
+        return EXIT_FAILURE;
+    }
 
     while (s_Running == SERVER_RUNNING) {
-        cppserv::Ref<cppserv::Socket> clientSocket = socket.Accept();
-
-        threadpool.Submit([clientSocket] {
-            CPPSERV_INFO("Accepted connection");
-            std::string request;
-            std::string buffer;
-            int received = 0;
-            while ((received = clientSocket->SocketSafeRead(buffer, 1024, 10)) > 0) {
-                CPPSERV_INFO("Received {0} bytes", received);
-                request += buffer;
-                if (received < 1024) {
-                    break;
-                }
-            }
-            
-            CPPSERV_INFO("Received request: {0}", request);
+        struct sockaddr_storage peer;
+        socklen_t peerLen;
+        int clientHandle = socket.AcceptHandle(peer, peerLen, SOCK_CLOEXEC);
+        if (clientHandle < 0) {
+            continue;
+        }
 
-            std::string response = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: 12\r\n\r\nHello World!";
-            clientSocket->SocketWrite(response);
-            clientSocket->Close();
-        });
+        uint64_t accepted = cppserv::TscClock::Now();
+        s_Metrics.accepts->Increment();
+        cppserv::Connection* connection = s_Connections.Acquire(clientHandle, peer, peerLen);
+        if (connection == nullptr) {
+            CPPSERV_WARN_RATE_LIMITED(1, "Connection limit of {} reached, dropping connections", MAX_CONNECTIONS);
+            ::close(clientHandle);
+            continue;
+        }
+
+        connection->GetTimeline().timestamps[cppserv::TIMESTAMP_ACCEPTED] = accepted;
+        submit_connection(connection->GetHandle());
+    }
+
+    if (!options.udpPort.empty()) {
+        datagramServer.Shutdown();
+        CPPSERV_INFO("Datagram server received {} datagrams", datagramServer.GetReceivedCount());
+    }
+
+    cppserv::BufferPoolStats bufferStats = cppserv::BufferPool::Get().GetStats();
+    CPPSERV_INFO("Buffer pool: {} of {} buffers in use, {} resident, {} acquisitions, {} exhausted",
+        bufferStats.inUse, bufferStats.capacity, bufferStats.resident, bufferStats.acquired, bufferStats.exhausted);
+
+    if (options.logger.mode == cppserv::LogMode::ASYNC) {
+        CPPSERV_INFO("Async logger dropped {} messages", cppserv::Logger::GetDroppedMessages());
     }
 
-    threadpool.Terminate();
-    threadpool.Shutdown();
+    adminServer.Shutdown();
+    s_TcpInfo.Shutdown();
+    // drains the queue and joins the workers before the subsystems they use are torn down
+    s_ThreadPool.Shutdown();
     socket.Close();
+    cppserv::AccessLog::Shutdown();
+    cppserv::TrafficCapture::Shutdown();
+
+    std::string lockReport = cppserv::InstrumentedMutex::Report();
+    std::string_view lines = lockReport;
+    while (!lines.empty()) {
+        size_t end = lines.find('\n');
+        CPPSERV_INFO("{}", lines.substr(0, end));
+        lines.remove_prefix(end == std::string_view::npos ? lines.size() : end + 1);
+    }
+    cppserv::Logger::Shutdown();
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
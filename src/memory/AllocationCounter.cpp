@@ -0,0 +1,51 @@
+#include "AllocationCounter.h"
+
+#include <new>
+#include <stdlib.h>
+
+namespace cppserv {
+
+    static thread_local size_t s_ThreadAllocations = 0;
+
+    size_t AllocationCounter::GetThreadAllocations() {
+        return s_ThreadAllocations;
+    }
+
+} // namespace cppserv
+
+// the array and nothrow variants of the standard library forward to these
+void* operator new(size_t size) {
+    cppserv::s_ThreadAllocations++;
+    void* ptr = malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    cppserv::s_ThreadAllocations++;
+    // posix_memalign needs at least pointer alignment, smaller ones can only be requested explicitly
+    size_t align = (size_t)alignment < sizeof(void*) ? sizeof(void*) : (size_t)alignment;
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, align, size == 0 ? 1 : size) != 0) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    free(ptr);
+}
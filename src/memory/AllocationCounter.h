@@ -0,0 +1,26 @@
+#ifndef __ALLOCATIONCOUNTER_H__
+#define __ALLOCATIONCOUNTER_H__
+
+#include <stddef.h>
+
+namespace cppserv {
+
+    /**
+     * \brief Counts global heap allocations per thread.
+     *
+     * The counter is maintained by the replacement `operator new` in AllocationCounter.cpp, which
+     * adds a thread local increment in front of `malloc`. Over-aligned allocations are counted too,
+     * they go through the replaced `std::align_val_t` overload.
+     */
+    class AllocationCounter {
+    public:
+        /**
+         * \brief Returns the number of `operator new` calls made by the calling thread so far.
+         */
+        static size_t GetThreadAllocations();
+    };
+
+} // namespace cppserv
+
+
+#endif // __ALLOCATIONCOUNTER_H__
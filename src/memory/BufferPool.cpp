@@ -0,0 +1,262 @@
+#include "BufferPool.h"
+
+#include <algorithm>
+#include <sched.h>
+#include <sys/mman.h>
+#include <string.h>
+
+#include "../logger/Logger.h"
+
+namespace cppserv {
+
+    static constexpr size_t BUFFER_POOL_HUGE_PAGE_SIZE = 2 * 1048576;
+
+    BufferPool::~BufferPool() {
+        Shutdown();
+    }
+
+    BufferPool& BufferPool::Get() {
+        static BufferPool s_Pool;
+        return s_Pool;
+    }
+
+    int BufferPool::Init(const BufferPoolConfig& config) {
+        m_Config = config;
+        if (m_Config.bufferSize == 0 || m_Config.maxBytes < m_Config.bufferSize) {
+            CPPSERV_ERROR("buffer pool error: invalid size {} / {}", m_Config.bufferSize, m_Config.maxBytes);
+            return -1;
+        }
+
+        m_Capacity = (uint32_t)(m_Config.maxBytes / m_Config.bufferSize);
+        m_RegionSize = (size_t)m_Capacity * m_Config.bufferSize;
+
+        if (m_Config.hugePages) {
+            // no MAP_NORESERVE: without reserved huge pages the mapping must fail here, not on first touch
+            size_t hugeSize = (m_RegionSize + BUFFER_POOL_HUGE_PAGE_SIZE - 1) / BUFFER_POOL_HUGE_PAGE_SIZE * BUFFER_POOL_HUGE_PAGE_SIZE;
+            void* region = mmap(NULL, hugeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (region != MAP_FAILED) {
+                m_Region = (char*)region;
+                m_RegionSize = hugeSize;
+                m_HugePages = true;
+            } else {
+                CPPSERV_WARN("buffer pool: no reserved huge pages ({}), falling back to transparent huge pages", strerror(errno));
+            }
+        }
+        if (m_Region == nullptr) {
+            void* region = mmap(NULL, m_RegionSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (region == MAP_FAILED) {
+                CPPSERV_ERROR("buffer pool mmap error: {}", strerror(errno));
+                return -1;
+            }
+            m_Region = (char*)region;
+            if (m_Config.hugePages && madvise(m_Region, m_RegionSize, MADV_HUGEPAGE) == 0) {
+                m_HugePages = true;
+            }
+        }
+
+        m_NumShards = std::thread::hardware_concurrency();
+        if (m_NumShards == 0) {
+            m_NumShards = 1;
+        }
+        m_Shards.reset(new Shard[m_NumShards]);
+        for (size_t i = 0; i < m_NumShards; i++) {
+            m_Shards[i].free.reserve(m_Capacity / m_NumShards + 1);
+        }
+        m_Trimmed.reset(new std::atomic<uint8_t>[m_Capacity]());
+
+        m_Stop = false;
+        if (m_Config.trimIntervalSeconds > 0 && !m_HugePages) {
+            m_Trimmer = std::thread([this] {
+                RunTrimmer();
+            });
+        }
+
+        CPPSERV_TRACE("Initializing buffer pool with {} buffers of {} bytes (huge pages: {})", m_Capacity, m_Config.bufferSize, m_HugePages);
+        return 0;
+    }
+
+    void BufferPool::Shutdown() {
+        {
+            std::unique_lock<std::mutex> lock(m_TrimMutex);
+            m_Stop = true;
+        }
+        m_TrimCV.notify_all();
+        if (m_Trimmer.joinable()) {
+            m_Trimmer.join();
+        }
+        if (m_Region != nullptr) {
+            munmap(m_Region, m_RegionSize);
+            m_Region = nullptr;
+        }
+    }
+
+    BufferPool::Shard& BufferPool::LocalShard() {
+        int cpu = sched_getcpu();
+        return m_Shards[(cpu < 0 ? 0 : (size_t)cpu) % m_NumShards];
+    }
+
+    char* BufferPool::Acquire() {
+        uint32_t index = UINT32_MAX;
+
+        Shard& local = LocalShard();
+        {
+            std::unique_lock<InstrumentedMutex> lock(local.mutex);
+            if (!local.free.empty()) {
+                index = local.free.back();
+                local.free.pop_back();
+            }
+        }
+
+        if (index == UINT32_MAX) {
+            // never used buffers first, they cost no lock
+            uint32_t next = m_NextUnused.load(std::memory_order_relaxed);
+            while (next < m_Capacity && !m_NextUnused.compare_exchange_weak(next, next + 1, std::memory_order_relaxed)) {}
+            if (next < m_Capacity) {
+                index = next;
+            }
+        }
+
+        if (index == UINT32_MAX) {
+            for (size_t i = 0; i < m_NumShards && index == UINT32_MAX; i++) {
+                Shard& shard = m_Shards[i];
+                std::unique_lock<InstrumentedMutex> lock(shard.mutex);
+                if (!shard.free.empty()) {
+                    index = shard.free.back();
+                    shard.free.pop_back();
+                }
+            }
+        }
+
+        if (index == UINT32_MAX) {
+            m_Exhausted.fetch_add(1, std::memory_order_relaxed);
+            m_Waiting.store(true, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        if (m_Trimmed[index].exchange(0, std::memory_order_relaxed) != 0) {
+            m_TrimmedCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+        m_InUse.fetch_add(1, std::memory_order_relaxed);
+        m_Acquired.fetch_add(1, std::memory_order_relaxed);
+        return m_Region + (size_t)index * m_Config.bufferSize;
+    }
+
+    void BufferPool::Release(char* buffer) {
+        if (buffer == nullptr) {
+            return;
+        }
+        uint32_t index = (uint32_t)((size_t)(buffer - m_Region) / m_Config.bufferSize);
+        Shard& local = LocalShard();
+        {
+            std::unique_lock<InstrumentedMutex> lock(local.mutex);
+            local.free.push_back(index);
+        }
+        m_InUse.fetch_sub(1, std::memory_order_relaxed);
+
+        if (m_Waiting.load(std::memory_order_relaxed) && m_Waiting.exchange(false, std::memory_order_relaxed)) {
+            if (m_AvailableCallback) {
+                m_AvailableCallback();
+            }
+        }
+    }
+
+    /**
+     * \brief Number of buffers the trimmer takes out of a shard at a time.
+     */
+    constexpr size_t BUFFER_POOL_TRIM_BATCH = 64;
+
+    size_t BufferPool::Trim() {
+        if (m_HugePages) {
+            // MADV_DONTNEED fails on hugetlb pages and splits transparent huge pages
+            return 0;
+        }
+
+        size_t trimmed = 0;
+        std::vector<uint32_t> batch;
+        batch.reserve(BUFFER_POOL_TRIM_BATCH);
+        for (size_t i = 0; i < m_NumShards; i++) {
+            Shard& shard = m_Shards[i];
+            size_t scanned = 0;
+            while (true) {
+                // the batch leaves the free list, so no buffer is handed out while madvise zeroes it
+                batch.clear();
+                {
+                    std::unique_lock<InstrumentedMutex> lock(shard.mutex);
+                    size_t position = std::min(scanned, shard.free.size());
+                    while (position < shard.free.size() && batch.size() < BUFFER_POOL_TRIM_BATCH) {
+                        uint32_t index = shard.free[position];
+                        if (m_Trimmed[index].load(std::memory_order_relaxed) != 0) {
+                            position++;
+                            continue;
+                        }
+                        batch.push_back(index);
+                        shard.free[position] = shard.free.back();
+                        shard.free.pop_back();
+                    }
+                    scanned = position;
+                    m_Trimming.fetch_add(batch.size(), std::memory_order_relaxed);
+                }
+                if (batch.empty()) {
+                    break;
+                }
+
+                for (uint32_t index : batch) {
+                    if (madvise(m_Region + (size_t)index * m_Config.bufferSize, m_Config.bufferSize, MADV_DONTNEED) != 0) {
+                        CPPSERV_ERROR("buffer pool madvise error: {}", strerror(errno));
+                        continue;
+                    }
+                    // counted before the buffer is back on a free list, where Acquire may take it again
+                    m_Trimmed[index].store(1, std::memory_order_relaxed);
+                    m_TrimmedCount.fetch_add(1, std::memory_order_relaxed);
+                    trimmed++;
+                }
+
+                {
+                    std::unique_lock<InstrumentedMutex> lock(shard.mutex);
+                    shard.free.insert(shard.free.end(), batch.begin(), batch.end());
+                }
+                m_Trimming.fetch_sub(batch.size(), std::memory_order_relaxed);
+                if (m_Waiting.load(std::memory_order_relaxed) && m_Waiting.exchange(false, std::memory_order_relaxed)) {
+                    if (m_AvailableCallback) {
+                        m_AvailableCallback();
+                    }
+                }
+            }
+        }
+        return trimmed;
+    }
+
+    void BufferPool::RunTrimmer() {
+        uint64_t lastAcquired = m_Acquired.load(std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(m_TrimMutex);
+        while (!m_Stop) {
+            m_TrimCV.wait_for(lock, std::chrono::seconds(m_Config.trimIntervalSeconds), [this] { return m_Stop; });
+            if (m_Stop) {
+                break;
+            }
+            uint64_t acquired = m_Acquired.load(std::memory_order_relaxed);
+            if (acquired == lastAcquired) {
+                size_t trimmed = Trim();
+                if (trimmed > 0) {
+                    CPPSERV_TRACE("Buffer pool idle, trimmed {} buffers", trimmed);
+                }
+            }
+            lastAcquired = acquired;
+        }
+    }
+
+    BufferPoolStats BufferPool::GetStats() const {
+        BufferPoolStats stats;
+        stats.bufferSize = m_Config.bufferSize;
+        stats.capacity = m_Capacity;
+        stats.inUse = m_InUse.load(std::memory_order_relaxed);
+        stats.trimmed = m_TrimmedCount.load(std::memory_order_relaxed);
+        size_t touched = m_NextUnused.load(std::memory_order_relaxed);
+        stats.resident = touched > stats.trimmed ? touched - stats.trimmed : 0;
+        stats.acquired = m_Acquired.load(std::memory_order_relaxed);
+        stats.exhausted = m_Exhausted.load(std::memory_order_relaxed);
+        stats.hugePages = m_HugePages;
+        return stats;
+    }
+
+} // namespace cppserv
@@ -0,0 +1,158 @@
+#ifndef __BUFFERPOOL_H__
+#define __BUFFERPOOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../core/cppservcore.h"
+#include "../diagnostics/InstrumentedMutex.h"
+
+namespace cppserv {
+
+    struct BufferPoolConfig {
+        size_t bufferSize = 16384;
+        size_t maxBytes = 256 * 1048576;
+        bool hugePages = false;
+        int trimIntervalSeconds = 10;
+    };
+
+    struct BufferPoolStats {
+        size_t bufferSize;
+        size_t capacity;
+        size_t inUse;
+        size_t resident;
+        size_t trimmed;
+        uint64_t acquired;
+        uint64_t exhausted;
+        bool hugePages;
+    };
+
+    /**
+     * \brief The process wide pool of fixed size I/O buffers.
+     *
+     * The whole pool is one virtual memory region of `maxBytes`, reserved up front and only backed by
+     * physical memory as buffers are touched, which makes `maxBytes` a hard cap: when every buffer is in
+     * use `Acquire` returns nullptr and the caller has to wait instead of growing the heap. Free buffers
+     * are kept in per-core lists, so threads on different cores do not share a lock. The region can be
+     * backed by 2 MB huge pages and, being a single contiguous range, registered with io_uring as fixed
+     * buffers.
+     *
+     * A background thread returns the memory of free buffers to the kernel (`MADV_DONTNEED`) once the
+     * pool was idle for a trim interval. A region backed by huge pages is never trimmed: hugetlb pages
+     * cannot be dropped per buffer and dropping part of a transparent huge page splits it.
+     */
+    class BufferPool {
+    public:
+        BufferPool() {}
+        ~BufferPool();
+
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+
+        /**
+         * \brief Reserves the buffer region and starts the trim thread.
+         *
+         * \param config The pool configuration.
+         * \return Returns 0 on success, or a negative value indicating an error.
+         */
+        int Init(const BufferPoolConfig& config);
+
+        /**
+         * \brief Stops the trim thread and unmaps the region. All buffers must have been released.
+         */
+        void Shutdown();
+
+        /**
+         * \brief Takes a buffer of `GetBufferSize()` bytes from the pool.
+         *
+         * \return Returns the buffer, or nullptr if the memory cap is reached.
+         */
+        char* Acquire();
+
+        /**
+         * \brief Returns a buffer to the pool.
+         *
+         * \param buffer A buffer obtained from `Acquire`.
+         */
+        void Release(char* buffer);
+
+        /**
+         * \brief Returns the memory of all free buffers to the kernel.
+         *
+         * Free buffers are taken out of their shard in small batches and advised without the shard lock
+         * held, then put back. Does nothing if the region is backed by huge pages.
+         *
+         * \return Returns the number of buffers that were trimmed.
+         */
+        size_t Trim();
+
+        /**
+         * \brief Registers a callback that is invoked after a buffer was released while the pool was exhausted.
+         *
+         * \param callback The callback, called from the releasing thread.
+         */
+        void SetAvailableCallback(std::function<void()> callback) { m_AvailableCallback = std::move(callback); }
+
+        /**
+         * \brief Returns true if at least one buffer can be acquired.
+         *
+         * Buffers the trimmer has taken off the free lists are not counted, they are reported free again
+         * once the batch is put back.
+         */
+        bool HasFree() const { return m_InUse.load(std::memory_order_relaxed) + m_Trimming.load(std::memory_order_relaxed) < m_Capacity; }
+
+        size_t GetBufferSize() const { return m_Config.bufferSize; }
+        char* GetRegion() const { return m_Region; }
+        size_t GetRegionSize() const { return m_RegionSize; }
+
+        BufferPoolStats GetStats() const;
+
+        /**
+         * \brief Returns the process wide pool.
+         */
+        static BufferPool& Get();
+
+    private:
+        struct alignas(64) Shard {
+            InstrumentedMutex mutex{ "buffer_pool_shard" };
+            std::vector<uint32_t> free;
+        };
+
+        Shard& LocalShard();
+        void RunTrimmer();
+
+    private:
+        BufferPoolConfig m_Config;
+        char* m_Region = nullptr;
+        size_t m_RegionSize = 0;
+        uint32_t m_Capacity = 0;
+        bool m_HugePages = false;
+
+        std::unique_ptr<Shard[]> m_Shards;
+        size_t m_NumShards = 0;
+        std::unique_ptr<std::atomic<uint8_t>[]> m_Trimmed;
+
+        std::atomic<uint32_t> m_NextUnused = 0;
+        std::atomic<size_t> m_InUse = 0;
+        std::atomic<size_t> m_TrimmedCount = 0;
+        std::atomic<size_t> m_Trimming = 0;
+        std::atomic<uint64_t> m_Acquired = 0;
+        std::atomic<uint64_t> m_Exhausted = 0;
+        std::atomic<bool> m_Waiting = false;
+        std::function<void()> m_AvailableCallback;
+
+        std::thread m_Trimmer;
+        std::mutex m_TrimMutex;
+        std::condition_variable m_TrimCV;
+        bool m_Stop = false;
+    };
+
+} // namespace cppserv
+
+
+#endif // __BUFFERPOOL_H__
@@ -0,0 +1,31 @@
+#include "RequestArena.h"
+
+#include "AllocationCounter.h"
+
+namespace cppserv {
+
+    RequestArena::RequestArena(size_t blockSize)
+        : m_Block(new std::byte[blockSize]),
+          m_Resource(m_Block.get(), blockSize, std::pmr::new_delete_resource()),
+          m_AllocationsAtBegin(0), m_LastHeapAllocations(0), m_HeapRequests(0) {
+
+    }
+
+    void RequestArena::Begin() {
+        m_AllocationsAtBegin = AllocationCounter::GetThreadAllocations();
+    }
+
+    void RequestArena::Reset() {
+        m_LastHeapAllocations = AllocationCounter::GetThreadAllocations() - m_AllocationsAtBegin;
+        if (m_LastHeapAllocations > 0) {
+            m_HeapRequests++;
+        }
+        m_Resource.release();
+    }
+
+    RequestArena& RequestArena::ForThread() {
+        static thread_local RequestArena s_Arena;
+        return s_Arena;
+    }
+
+} // namespace cppserv
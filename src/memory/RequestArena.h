@@ -0,0 +1,87 @@
+#ifndef __REQUESTARENA_H__
+#define __REQUESTARENA_H__
+
+#include <memory>
+#include <memory_resource>
+
+namespace cppserv {
+
+    /**
+     * \brief Default size of the block every worker keeps for its requests.
+     */
+    constexpr size_t REQUEST_ARENA_BLOCK_SIZE = 64 * 1024;
+
+    /**
+     * \brief A bump allocator for everything that lives exactly as long as one request.
+     *
+     * The arena is a `std::pmr::monotonic_buffer_resource` over a block that is allocated once per worker
+     * and reused for every request. Allocations are pointer bumps and deallocations are no-ops; `Reset`
+     * hands the whole block back in O(1). Only requests that outgrow the block take additional chunks
+     * from the heap, and those are released on reset.
+     *
+     * Between `Begin` and `Reset` the arena also tracks how many global heap allocations the worker made,
+     * which should be zero for a request that fits the block.
+     */
+    class RequestArena {
+    public:
+        explicit RequestArena(size_t blockSize = REQUEST_ARENA_BLOCK_SIZE);
+        ~RequestArena() {}
+
+        RequestArena(const RequestArena&) = delete;
+        RequestArena& operator=(const RequestArena&) = delete;
+
+        /**
+         * \brief Marks the start of a request.
+         */
+        void Begin();
+
+        /**
+         * \brief Releases everything allocated since `Begin` and records the request's heap allocation count.
+         *
+         * All objects allocated from the arena must have been destroyed (or be trivially destructible).
+         */
+        void Reset();
+
+        /**
+         * \brief Allocates scratch memory for the current request.
+         *
+         * \param size The number of bytes.
+         * \param alignment The required alignment.
+         * \return Returns a pointer to memory that stays valid until `Reset`.
+         */
+        void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+            return m_Resource.allocate(size, alignment);
+        }
+
+        /**
+         * \brief Returns the memory resource of the arena, e.g. to construct a HttpRequest.
+         */
+        std::pmr::memory_resource* GetResource() { return &m_Resource; }
+
+        /**
+         * \brief Returns the number of global heap allocations the last completed request made on this worker.
+         */
+        size_t GetLastHeapAllocations() const { return m_LastHeapAllocations; }
+
+        /**
+         * \brief Returns the number of requests on this worker that made at least one heap allocation.
+         */
+        size_t GetHeapRequests() const { return m_HeapRequests; }
+
+        /**
+         * \brief Returns the arena of the calling worker thread.
+         */
+        static RequestArena& ForThread();
+
+    private:
+        std::unique_ptr<std::byte[]> m_Block;
+        std::pmr::monotonic_buffer_resource m_Resource;
+        size_t m_AllocationsAtBegin;
+        size_t m_LastHeapAllocations;
+        size_t m_HeapRequests;
+    };
+
+} // namespace cppserv
+
+
+#endif // __REQUESTARENA_H__
@@ -0,0 +1,149 @@
+#include "HardwareCounters.h"
+
+#include <atomic>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "MetricsRegistry.h"
+#include "../logger/Logger.h"
+
+namespace cppserv {
+
+    bool HardwareCounters::s_Enabled = false;
+
+    static const uint64_t s_EventConfigs[HW_EVENT_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    static const uint32_t s_EventTypes[HW_EVENT_COUNT] = {
+        PERF_TYPE_HARDWARE,
+        PERF_TYPE_HARDWARE,
+        PERF_TYPE_HW_CACHE,
+        PERF_TYPE_HARDWARE,
+        PERF_TYPE_HARDWARE
+    };
+
+    static std::atomic<bool> s_Reported[HW_EVENT_COUNT];
+
+    /**
+     * \brief The event group of one thread.
+     */
+    class ThreadCounters {
+    public:
+        ThreadCounters() {
+            for (int event = 0; event < HW_EVENT_COUNT; event++) {
+                struct perf_event_attr attr;
+                memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = s_EventTypes[event];
+                attr.config = s_EventConfigs[event];
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP;
+                // the leader starts the whole group
+                attr.disabled = m_Leader < 0;
+                int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, m_Leader, PERF_FLAG_FD_CLOEXEC);
+                if (fd < 0) {
+                    // every thread fails the same way, report it once
+                    if (!s_Reported[event].exchange(true)) {
+                        CPPSERV_WARN("perf_event_open error for {}: {}", HardwareEventToString((HardwareEvent)event), strerror(errno));
+                    }
+                    continue;
+                }
+                if (m_Leader < 0) {
+                    m_Leader = fd;
+                }
+                m_Fds[m_Count] = fd;
+                m_Events[m_Count++] = event;
+            }
+            if (m_Leader >= 0) {
+                ioctl(m_Leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ioctl(m_Leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+        }
+
+        ~ThreadCounters() {
+            for (int i = m_Count - 1; i >= 0; i--) {
+                close(m_Fds[i]);
+            }
+        }
+
+        bool Read(HardwareSample& sample) {
+            if (m_Leader < 0) {
+                return false;
+            }
+            // nr followed by one value per member, in the order they were opened
+            uint64_t data[1 + HW_EVENT_COUNT];
+            ssize_t size = read(m_Leader, data, sizeof(data));
+            if (size < (ssize_t)sizeof(uint64_t) || data[0] != (uint64_t)m_Count) {
+                return false;
+            }
+            for (int i = 0; i < m_Count; i++) {
+                sample.values[m_Events[i]] = data[1 + i];
+            }
+            sample.valid = true;
+            return true;
+        }
+
+    private:
+        int m_Leader = -1;
+        int m_Count = 0;
+        int m_Fds[HW_EVENT_COUNT] = {};
+        int m_Events[HW_EVENT_COUNT] = {};
+
+    };
+
+    bool HardwareCounters::Read(HardwareSample& sample) {
+        sample.valid = false;
+        if (!s_Enabled) {
+            return false;
+        }
+        static thread_local ThreadCounters t_Counters;
+        return t_Counters.Read(sample);
+    }
+
+    void HardwareStageCounters::Register(MetricsRegistry& registry, const std::string& labels) {
+        const std::string help = "CPU events counted in user space per request stage, see --hw-counters.";
+        for (int stage = STAGE_FIRST_BYTE; stage < STAGE_COUNT; stage++) {
+            for (int event = 0; event < HW_EVENT_COUNT; event++) {
+                std::string seriesLabels = labels + (labels.empty() ? "" : ",")
+                    + "stage=\"" + RequestStageToString((RequestStage)stage) + "\",event=\"" + HardwareEventToString((HardwareEvent)event) + "\"";
+                m_Events[stage][event] = &registry.AddCounter("cppserv_hardware_events_total", help, seriesLabels);
+            }
+        }
+    }
+
+    void HardwareStageCounters::Record(const HardwareTimeline& timeline) {
+        for (int stage = STAGE_FIRST_BYTE; stage < STAGE_COUNT; stage++) {
+            const HardwareSample& end = timeline.samples[stage + 1];
+            if (!end.valid || m_Events[stage][0] == nullptr) {
+                continue;
+            }
+            // like RequestTimeline, a stage starts at the last reading that was taken
+            const HardwareSample* begin = nullptr;
+            for (int boundary = stage; boundary >= TIMESTAMP_DEQUEUED; boundary--) {
+                if (timeline.samples[boundary].valid) {
+                    begin = &timeline.samples[boundary];
+                    break;
+                }
+            }
+            if (begin == nullptr) {
+                continue;
+            }
+            for (int event = 0; event < HW_EVENT_COUNT; event++) {
+                if (end.values[event] > begin->values[event]) {
+                    m_Events[stage][event]->Increment(end.values[event] - begin->values[event]);
+                }
+            }
+        }
+    }
+
+} // namespace cppserv
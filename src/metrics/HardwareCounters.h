@@ -0,0 +1,115 @@
+#ifndef __HARDWARECOUNTERS_H__
+#define __HARDWARECOUNTERS_H__
+
+#include <string>
+#include <cstdint>
+
+#include "Metrics.h"
+#include "RequestTimeline.h"
+
+namespace cppserv {
+
+    class MetricsRegistry;
+
+    /**
+     * \brief The CPU events counted per request stage.
+     */
+    enum HardwareEvent {
+        HW_CYCLES = 0,
+        HW_INSTRUCTIONS,
+        HW_L1D_MISSES,
+        HW_LLC_MISSES,
+        HW_BRANCH_MISSES,
+        HW_EVENT_COUNT
+    };
+
+    /**
+     * \brief Returns the name of an event, as used in metric labels.
+     */
+    inline const char* HardwareEventToString(HardwareEvent event) {
+        switch (event) {
+        case HW_CYCLES: return "cycles";
+        case HW_INSTRUCTIONS: return "instructions";
+        case HW_L1D_MISSES: return "l1d_misses";
+        case HW_LLC_MISSES: return "llc_misses";
+        case HW_BRANCH_MISSES: return "branch_misses";
+        default: return "unknown";
+        }
+    }
+
+    /**
+     * \brief The counter values of the calling thread at one point in time.
+     */
+    struct HardwareSample {
+        uint64_t values[HW_EVENT_COUNT] = {};
+        // false if the counters were not read, e.g. because the CPU or the kernel does not provide them
+        bool valid = false;
+    };
+
+    /**
+     * \brief Per-thread CPU performance counters opened with `perf_event_open`.
+     *
+     * Every thread that reads the counters opens one event group on its first read; the group is
+     * scheduled onto the PMU as a unit, so all events of a sample cover the same instructions. Only user
+     * space is counted, which `perf_event_paranoid` up to 2 permits for the own thread. A read is one
+     * `read` system call, the counters are therefore optional. Events the CPU does not provide (e.g. in
+     * virtual machines) stay 0; without any hardware event samples are invalid.
+     */
+    class HardwareCounters {
+    public:
+        /**
+         * \brief Enables reading the counters. Off by default, reads then return invalid samples.
+         */
+        static void Enable() { s_Enabled = true; }
+        static bool IsEnabled() { return s_Enabled; }
+
+        /**
+         * \brief Reads the counters of the calling thread.
+         *
+         * \param sample Receives the counter values.
+         * \return Returns true if the sample is valid.
+         */
+        static bool Read(HardwareSample& sample);
+
+    private:
+        static bool s_Enabled;
+
+    };
+
+    /**
+     * \brief Counter readings taken at the boundaries of the stages of one request, see RequestTimeline.
+     */
+    struct HardwareTimeline {
+        HardwareSample samples[STAGE_COUNT + 1];
+
+        void Mark(RequestTimestamp boundary) { HardwareCounters::Read(samples[boundary]); }
+    };
+
+    /**
+     * \brief The event counts of the stages of all requests of one route.
+     *
+     * The queue stage is not counted, it is spent on the accepting thread.
+     */
+    class HardwareStageCounters {
+    public:
+        /**
+         * \brief Registers one counter per stage and event as `cppserv_hardware_events_total`.
+         *
+         * \param registry The registry.
+         * \param labels The labels of the route, e.g. `route="/metrics"`.
+         */
+        void Register(MetricsRegistry& registry, const std::string& labels);
+
+        /**
+         * \brief Adds the differences between the readings of a request to the counters.
+         */
+        void Record(const HardwareTimeline& timeline);
+
+    private:
+        Counter* m_Events[STAGE_COUNT][HW_EVENT_COUNT] = {};
+
+    };
+
+} // namespace cppserv
+
+#endif // __HARDWARECOUNTERS_H__
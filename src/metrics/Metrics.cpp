@@ -0,0 +1,82 @@
+#include "Metrics.h"
+
+#include <thread>
+#include <algorithm>
+
+namespace cppserv {
+
+    size_t MetricsShardCount() {
+        static const size_t s_Count = [] {
+            size_t cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+            size_t count = 1;
+            while (count < cores && count < METRICS_MAX_SHARDS) {
+                count <<= 1;
+            }
+            return count;
+        }();
+        return s_Count;
+    }
+
+    uint64_t Counter::GetValue() const {
+        int64_t value = 0;
+        for (size_t i = 0; i < MetricsShardCount(); i++) {
+            value += m_Cells[i].value.load(std::memory_order_relaxed);
+        }
+        return (uint64_t)value;
+    }
+
+    int64_t Gauge::GetValue() const {
+        int64_t value = 0;
+        for (size_t i = 0; i < MetricsShardCount(); i++) {
+            value += m_Cells[i].value.load(std::memory_order_relaxed);
+        }
+        return value;
+    }
+
+    uint64_t HistogramSnapshot::Percentile(double fraction) const {
+        if (count == 0) {
+            return 0;
+        }
+        uint64_t rank = (uint64_t)(fraction * (double)count);
+        if (rank >= count) {
+            rank = count - 1;
+        }
+        uint64_t seen = 0;
+        for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen > rank) {
+                return Histogram::BucketUpperBound(i);
+            }
+        }
+        return Histogram::BucketUpperBound(HISTOGRAM_BUCKETS - 1);
+    }
+
+    Histogram::Histogram() : m_Shards(new Shard[MetricsShardCount()]()) {}
+
+    HistogramSnapshot Histogram::Snapshot() const {
+        HistogramSnapshot snapshot;
+        for (size_t shard = 0; shard < MetricsShardCount(); shard++) {
+            for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+                uint64_t count = m_Shards[shard].buckets[i].load(std::memory_order_relaxed);
+                snapshot.buckets[i] += count;
+                snapshot.count += count;
+            }
+            snapshot.sum += m_Shards[shard].sum.load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+    uint64_t Histogram::BucketUpperBound(size_t index) {
+        if (index < HISTOGRAM_LINEAR_BUCKETS) {
+            return (uint64_t)index;
+        }
+        if (index == HISTOGRAM_BUCKETS - 1) {
+            return UINT64_MAX;
+        }
+        size_t exponent = (index - HISTOGRAM_LINEAR_BUCKETS) / HISTOGRAM_SUB_BUCKETS + 4;
+        uint64_t sub = (index - HISTOGRAM_LINEAR_BUCKETS) % HISTOGRAM_SUB_BUCKETS;
+        uint64_t lower = (HISTOGRAM_SUB_BUCKETS + sub) << (exponent - 3);
+        return lower + (1ull << (exponent - 3)) - 1;
+    }
+
+} // namespace cppserv
@@ -0,0 +1,171 @@
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace cppserv {
+
+    /**
+     * \brief Upper limit of the shards of a metric.
+     */
+    constexpr size_t METRICS_MAX_SHARDS = 64;
+
+    /**
+     * \brief Histogram values at or above 2^HISTOGRAM_MAX_EXPONENT land in the last bucket.
+     */
+    constexpr size_t HISTOGRAM_MAX_EXPONENT = 40;
+
+    /**
+     * \brief Number of sub buckets per power of two, 8 keeps the relative error below 12.5%.
+     */
+    constexpr size_t HISTOGRAM_SUB_BUCKETS = 8;
+
+    /**
+     * \brief Values below this are counted exactly.
+     */
+    constexpr size_t HISTOGRAM_LINEAR_BUCKETS = 16;
+
+    /**
+     * \brief The linear buckets, the sub buckets of every power of two below the maximum and one overflow bucket.
+     */
+    constexpr size_t HISTOGRAM_BUCKETS = HISTOGRAM_LINEAR_BUCKETS + (HISTOGRAM_MAX_EXPONENT - 4) * HISTOGRAM_SUB_BUCKETS + 1;
+
+    /**
+     * \brief Returns the number of shards every metric has: the core count rounded up to a power of two.
+     */
+    size_t MetricsShardCount();
+
+    /**
+     * \brief Returns the shard of the calling thread.
+     *
+     * Threads are assigned shards round robin on first use. With one worker per core every worker
+     * updates its own cache lines; if there are more threads than shards they share, which stays
+     * correct because the cells are updated atomically.
+     */
+    inline size_t MetricsShard() {
+        static thread_local size_t t_Shard = SIZE_MAX;
+        if (t_Shard == SIZE_MAX) {
+            static std::atomic<size_t> s_NextShard = 0;
+            t_Shard = s_NextShard.fetch_add(1, std::memory_order_relaxed) & (MetricsShardCount() - 1);
+        }
+        return t_Shard;
+    }
+
+    /**
+     * \brief A cache line that only the threads of one shard write.
+     */
+    struct alignas(64) MetricsCell {
+        std::atomic<int64_t> value = 0;
+    };
+
+    /**
+     * \brief A monotonically increasing counter, summed over its shards on scrape.
+     */
+    class Counter {
+    public:
+        Counter() : m_Cells(new MetricsCell[MetricsShardCount()]) {}
+
+        void Increment(uint64_t amount = 1) {
+            m_Cells[MetricsShard()].value.fetch_add((int64_t)amount, std::memory_order_relaxed);
+        }
+
+        uint64_t GetValue() const;
+
+    private:
+        std::unique_ptr<MetricsCell[]> m_Cells;
+
+    };
+
+    /**
+     * \brief A value that goes up and down, e.g. requests in flight. Shards hold deltas, not values.
+     */
+    class Gauge {
+    public:
+        Gauge() : m_Cells(new MetricsCell[MetricsShardCount()]) {}
+
+        void Add(int64_t amount) {
+            m_Cells[MetricsShard()].value.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        void Increment() { Add(1); }
+        void Decrement() { Add(-1); }
+
+        int64_t GetValue() const;
+
+    private:
+        std::unique_ptr<MetricsCell[]> m_Cells;
+
+    };
+
+    /**
+     * \brief A snapshot of a histogram, summed over all shards.
+     */
+    struct HistogramSnapshot {
+        uint64_t buckets[HISTOGRAM_BUCKETS] = {};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+
+        /**
+         * \brief Returns the value below which the given fraction of the recorded values lies.
+         */
+        uint64_t Percentile(double fraction) const;
+    };
+
+    /**
+     * \brief A log-linear (HDR style) histogram of unsigned values, usually nanoseconds.
+     *
+     * Values below 16 have their own buckets, larger values are grouped into 8 buckets per power of
+     * two, which bounds the relative error to 12.5% over the whole range up to 2^40. Recording is two
+     * relaxed additions on the cache lines of the caller's shard.
+     */
+    class Histogram {
+    public:
+        Histogram();
+
+        void Record(uint64_t value) {
+            Shard& shard = m_Shards[MetricsShard()];
+            shard.buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            shard.sum.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        /**
+         * \brief Sums all shards.
+         */
+        HistogramSnapshot Snapshot() const;
+
+        /**
+         * \brief Returns the bucket of a value.
+         */
+        static size_t BucketIndex(uint64_t value) {
+            if (value < HISTOGRAM_LINEAR_BUCKETS) {
+                return (size_t)value;
+            }
+            size_t exponent = 63 - (size_t)__builtin_clzll(value);
+            if (exponent >= HISTOGRAM_MAX_EXPONENT) {
+                return HISTOGRAM_BUCKETS - 1;
+            }
+            size_t sub = (size_t)(value >> (exponent - 3)) & (HISTOGRAM_SUB_BUCKETS - 1);
+            return HISTOGRAM_LINEAR_BUCKETS + (exponent - 4) * HISTOGRAM_SUB_BUCKETS + sub;
+        }
+
+        /**
+         * \brief Returns the largest value that falls into a bucket.
+         */
+        static uint64_t BucketUpperBound(size_t index);
+
+    private:
+        struct alignas(64) Shard {
+            std::atomic<uint64_t> buckets[HISTOGRAM_BUCKETS];
+            std::atomic<uint64_t> sum;
+        };
+
+        std::unique_ptr<Shard[]> m_Shards;
+
+    };
+
+} // namespace cppserv
+
+#endif // __METRICS_H__
@@ -0,0 +1,157 @@
+#include "MetricsRegistry.h"
+
+#include <cstdio>
+#include <iterator>
+
+namespace cppserv {
+
+    /**
+     * \brief The `le` buckets of exported histograms in nanoseconds, the fine buckets are folded into these.
+     */
+    static const uint64_t s_ExportBounds[] = {
+        10000, 25000, 50000, 100000, 250000, 500000,
+        1000000, 2500000, 5000000, 10000000, 25000000, 50000000,
+        100000000, 250000000, 500000000, 1000000000, 2500000000, 5000000000, 10000000000
+    };
+
+    /**
+     * \brief The `le` buckets of exported histograms of plain quantities.
+     */
+    static const uint64_t s_ExportCountBounds[] = {
+        0, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 1000000, 10000000
+    };
+
+    static void AppendNumber(std::string& out, double value) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.9g", value);
+        out += buffer;
+    }
+
+    static void AppendName(std::string& out, const std::string& name, const std::string& suffix, const std::string& labels, const std::string& extra = "") {
+        out += name;
+        out += suffix;
+        if (!labels.empty() || !extra.empty()) {
+            out += '{';
+            out += labels;
+            if (!labels.empty() && !extra.empty()) {
+                out += ',';
+            }
+            out += extra;
+            out += '}';
+        }
+        out += ' ';
+    }
+
+    MetricsRegistry& MetricsRegistry::Get() {
+        static MetricsRegistry s_Registry;
+        return s_Registry;
+    }
+
+    MetricsRegistry::Family& MetricsRegistry::GetFamily(const std::string& name, const std::string& help, MetricType type) {
+        for (Family& family : m_Families) {
+            if (family.name == name) {
+                return family;
+            }
+        }
+        m_Families.push_back({ name, help, type, {} });
+        return m_Families.back();
+    }
+
+    Counter& MetricsRegistry::AddCounter(const std::string& name, const std::string& help, const std::string& labels) {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        Counter& counter = m_Counters.emplace_back();
+        Series series;
+        series.labels = labels;
+        series.counter = &counter;
+        GetFamily(name, help, MetricType::COUNTER).series.push_back(std::move(series));
+        return counter;
+    }
+
+    Gauge& MetricsRegistry::AddGauge(const std::string& name, const std::string& help, const std::string& labels) {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        Gauge& gauge = m_Gauges.emplace_back();
+        Series series;
+        series.labels = labels;
+        series.gauge = &gauge;
+        GetFamily(name, help, MetricType::GAUGE).series.push_back(std::move(series));
+        return gauge;
+    }
+
+    void MetricsRegistry::AddGaugeFunction(const std::string& name, const std::string& help, std::function<double()> function, const std::string& labels) {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        Series series;
+        series.labels = labels;
+        series.function = std::move(function);
+        GetFamily(name, help, MetricType::GAUGE).series.push_back(std::move(series));
+    }
+
+    Histogram& MetricsRegistry::AddHistogram(const std::string& name, const std::string& help, const std::string& labels,
+        HistogramUnit unit) {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        Histogram& histogram = m_Histograms.emplace_back();
+        Series series;
+        series.labels = labels;
+        series.histogram = &histogram;
+        series.unit = unit;
+        GetFamily(name, help, MetricType::HISTOGRAM).series.push_back(std::move(series));
+        return histogram;
+    }
+
+    std::string MetricsRegistry::Render() {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        std::string out;
+        for (const Family& family : m_Families) {
+            out += "# HELP " + family.name + " " + family.help + "\n";
+            out += "# TYPE " + family.name + " ";
+            out += family.type == MetricType::COUNTER ? "counter\n" : family.type == MetricType::GAUGE ? "gauge\n" : "histogram\n";
+
+            for (const Series& series : family.series) {
+                if (series.histogram != nullptr) {
+                    RenderHistogram(out, family, series);
+                    continue;
+                }
+                AppendName(out, family.name, "", series.labels);
+                if (series.counter != nullptr) {
+                    out += std::to_string(series.counter->GetValue());
+                } else if (series.gauge != nullptr) {
+                    out += std::to_string(series.gauge->GetValue());
+                } else {
+                    AppendNumber(out, series.function());
+                }
+                out += '\n';
+            }
+        }
+        return out;
+    }
+
+    void MetricsRegistry::RenderHistogram(std::string& out, const Family& family, const Series& series) {
+        HistogramSnapshot snapshot = series.histogram->Snapshot();
+        bool count = series.unit == HistogramUnit::COUNT;
+        const uint64_t* bounds = count ? s_ExportCountBounds : s_ExportBounds;
+        size_t boundCount = count ? std::size(s_ExportCountBounds) : std::size(s_ExportBounds);
+        double scale = count ? 1.0 : 1e9;
+
+        // a fine bucket is counted in the first exported bucket that contains its upper bound
+        size_t bucket = 0;
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < boundCount; i++) {
+            uint64_t bound = bounds[i];
+            while (bucket < HISTOGRAM_BUCKETS && Histogram::BucketUpperBound(bucket) <= bound) {
+                cumulative += snapshot.buckets[bucket++];
+            }
+            std::string le = "le=\"";
+            AppendNumber(le, (double)bound / scale);
+            le += "\"";
+            AppendName(out, family.name, "_bucket", series.labels, le);
+            out += std::to_string(cumulative) + "\n";
+        }
+        AppendName(out, family.name, "_bucket", series.labels, "le=\"+Inf\"");
+        out += std::to_string(snapshot.count) + "\n";
+        AppendName(out, family.name, "_sum", series.labels);
+        AppendNumber(out, (double)snapshot.sum / scale);
+        out += "\n";
+        AppendName(out, family.name, "_count", series.labels);
+        out += std::to_string(snapshot.count) + "\n";
+    }
+
+} // namespace cppserv
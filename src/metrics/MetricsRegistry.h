@@ -0,0 +1,107 @@
+#ifndef __METRICSREGISTRY_H__
+#define __METRICSREGISTRY_H__
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <functional>
+
+#include "Metrics.h"
+
+namespace cppserv {
+
+    /**
+     * \brief What the values of a histogram are, decides the exported buckets and scale.
+     */
+    enum class HistogramUnit {
+        // durations, exported in seconds
+        NANOSECONDS,
+        // plain quantities (segments, bytes, retransmits), exported unscaled
+        COUNT
+    };
+
+    /**
+     * \brief Owns all metrics of the process and renders them in the Prometheus text format.
+     *
+     * Metrics are registered at startup and live as long as the process; the returned references are
+     * kept by the code that updates them, so the request path never looks anything up. Scraping sums
+     * the shards of every metric.
+     */
+    class MetricsRegistry {
+    public:
+        /**
+         * \brief Returns the registry of the process.
+         */
+        static MetricsRegistry& Get();
+
+        /**
+         * \brief Registers a counter.
+         *
+         * \param name The metric name, e.g. `cppserv_accepts_total`.
+         * \param help The help text.
+         * \param labels The labels in Prometheus syntax without braces, e.g. `status="200"`, may be empty.
+         * \return Returns the counter.
+         */
+        Counter& AddCounter(const std::string& name, const std::string& help, const std::string& labels = "");
+
+        /**
+         * \brief Registers a gauge that is updated by deltas.
+         */
+        Gauge& AddGauge(const std::string& name, const std::string& help, const std::string& labels = "");
+
+        /**
+         * \brief Registers a gauge whose value is read on scrape, e.g. a queue length.
+         */
+        void AddGaugeFunction(const std::string& name, const std::string& help, std::function<double()> function, const std::string& labels = "");
+
+        /**
+         * \brief Registers a histogram of nanoseconds, exported in seconds, or of plain quantities.
+         */
+        Histogram& AddHistogram(const std::string& name, const std::string& help, const std::string& labels = "",
+            HistogramUnit unit = HistogramUnit::NANOSECONDS);
+
+        /**
+         * \brief Renders all metrics in the Prometheus text exposition format.
+         */
+        std::string Render();
+
+    private:
+        enum class MetricType {
+            COUNTER,
+            GAUGE,
+            HISTOGRAM
+        };
+
+        struct Series {
+            std::string labels;
+            Counter* counter = nullptr;
+            Gauge* gauge = nullptr;
+            std::function<double()> function;
+            Histogram* histogram = nullptr;
+            HistogramUnit unit = HistogramUnit::NANOSECONDS;
+        };
+
+        struct Family {
+            std::string name;
+            std::string help;
+            MetricType type;
+            std::vector<Series> series;
+        };
+
+        Family& GetFamily(const std::string& name, const std::string& help, MetricType type);
+        void RenderHistogram(std::string& out, const Family& family, const Series& series);
+
+    private:
+        std::mutex m_Mutex;
+        std::deque<Family> m_Families;
+        std::deque<Counter> m_Counters;
+        std::deque<Gauge> m_Gauges;
+        std::deque<Histogram> m_Histograms;
+
+    };
+
+} // namespace cppserv
+
+#endif // __METRICSREGISTRY_H__
@@ -0,0 +1,93 @@
+#ifndef __REQUESTTIMELINE_H__
+#define __REQUESTTIMELINE_H__
+
+#include <cstdint>
+
+#include "TscClock.h"
+
+namespace cppserv {
+
+    /**
+     * \brief The stages between two timestamps of a RequestTimeline.
+     */
+    enum RequestStage {
+        STAGE_QUEUE = 0,     // accepted -> dequeued by a worker
+        STAGE_FIRST_BYTE,    // dequeued -> first byte received (includes the TLS handshake)
+        STAGE_READ,          // first byte -> headers parsed
+        STAGE_HANDLE,        // parsed -> handler done
+        STAGE_WRITE,         // handler done -> last byte written
+        STAGE_COUNT
+    };
+
+    /**
+     * \brief Returns the name of a stage, as used in metric labels.
+     */
+    inline const char* RequestStageToString(RequestStage stage) {
+        switch (stage) {
+        case STAGE_QUEUE: return "queue";
+        case STAGE_FIRST_BYTE: return "first_byte";
+        case STAGE_READ: return "read";
+        case STAGE_HANDLE: return "handle";
+        case STAGE_WRITE: return "write";
+        default: return "unknown";
+        }
+    }
+
+    /**
+     * \brief Boundaries of a RequestTimeline.
+     */
+    enum RequestTimestamp {
+        TIMESTAMP_ACCEPTED = 0,
+        TIMESTAMP_DEQUEUED,
+        TIMESTAMP_FIRST_BYTE,
+        TIMESTAMP_PARSED,
+        TIMESTAMP_HANDLED,
+        TIMESTAMP_WRITTEN
+    };
+
+    /**
+     * \brief TscClock readings taken at the boundaries of the stages of one request.
+     *
+     * A timestamp that was never taken (e.g. no byte arrived) is 0; the stage that ends there then
+     * has a duration of 0 and the next stage starts at the last timestamp that was taken.
+     */
+    struct RequestTimeline {
+        uint64_t timestamps[STAGE_COUNT + 1] = {};
+
+        void Mark(RequestTimestamp boundary) { timestamps[boundary] = TscClock::Now(); }
+
+        /**
+         * \brief Returns the duration of a stage in nanoseconds.
+         */
+        uint64_t StageNanoseconds(RequestStage stage) const {
+            uint64_t end = timestamps[stage + 1];
+            if (end == 0) {
+                return 0;
+            }
+            for (int begin = stage; begin >= 0; begin--) {
+                if (timestamps[begin] != 0) {
+                    return TscClock::Between(timestamps[begin], end);
+                }
+            }
+            return 0;
+        }
+
+        /**
+         * \brief Returns the time from accept to the last timestamp that was taken, in nanoseconds.
+         */
+        uint64_t TotalNanoseconds() const {
+            if (timestamps[TIMESTAMP_ACCEPTED] == 0) {
+                return 0;
+            }
+            for (int end = STAGE_COUNT; end > 0; end--) {
+                if (timestamps[end] != 0) {
+                    return TscClock::Between(timestamps[0], timestamps[end]);
+                }
+            }
+            return 0;
+        }
+    };
+
+} // namespace cppserv
+
+#endif // __REQUESTTIMELINE_H__
@@ -0,0 +1,45 @@
+#include "TscClock.h"
+#include "../logger/Logger.h"
+
+#include <cpuid.h>
+
+namespace cppserv {
+
+    bool TscClock::s_UseTsc = false;
+    double TscClock::s_NanosecondsPerTick = 1.0;
+
+    /**
+     * \brief Returns true if the CPU reports an invariant TSC (constant rate, ticking in all C-states).
+     */
+    static bool HasInvariantTsc() {
+        unsigned int eax, ebx, ecx, edx;
+        if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007) {
+            return false;
+        }
+        __cpuid(0x80000007, eax, ebx, ecx, edx);
+        return (edx & (1u << 8)) != 0;
+    }
+
+    void TscClock::Calibrate() {
+        if (!HasInvariantTsc()) {
+            s_UseTsc = false;
+            s_NanosecondsPerTick = 1.0;
+            CPPSERV_WARN("No invariant TSC, request timings use CLOCK_MONOTONIC");
+            return;
+        }
+
+        // measure the rate over 20ms, long enough to make the clock_gettime jitter negligible
+        uint64_t startNs = MonotonicNanoseconds();
+        uint64_t startTicks = __rdtsc();
+        uint64_t endNs = startNs;
+        while (endNs - startNs < 20000000) {
+            endNs = MonotonicNanoseconds();
+        }
+        uint64_t endTicks = __rdtsc();
+
+        s_NanosecondsPerTick = (double)(endNs - startNs) / (double)(endTicks - startTicks);
+        s_UseTsc = true;
+        CPPSERV_TRACE("TSC runs at {:.3f} GHz", 1.0 / s_NanosecondsPerTick);
+    }
+
+} // namespace cppserv
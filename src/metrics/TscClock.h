@@ -0,0 +1,63 @@
+#ifndef __TSCCLOCK_H__
+#define __TSCCLOCK_H__
+
+#include <cstdint>
+#include <ctime>
+#include <x86intrin.h>
+
+namespace cppserv {
+
+    /**
+     * \brief A monotonic clock that reads the time stamp counter.
+     *
+     * `rdtsc` costs a few nanoseconds, a fraction of `clock_gettime`. The ticks are converted to
+     * nanoseconds with a rate measured against CLOCK_MONOTONIC by `Calibrate`. On CPUs without an
+     * invariant TSC the clock falls back to CLOCK_MONOTONIC and ticks are nanoseconds.
+     */
+    class TscClock {
+    public:
+        /**
+         * \brief Detects an invariant TSC and measures its rate, call once at startup.
+         */
+        static void Calibrate();
+
+        /**
+         * \brief Returns the current time in ticks.
+         */
+        static uint64_t Now() {
+            if (s_UseTsc) {
+                return __rdtsc();
+            }
+            return MonotonicNanoseconds();
+        }
+
+        /**
+         * \brief Converts a number of ticks to nanoseconds.
+         */
+        static uint64_t ToNanoseconds(uint64_t ticks) { return (uint64_t)((double)ticks * s_NanosecondsPerTick); }
+
+        /**
+         * \brief Returns the nanoseconds between two readings, 0 if `to` is not after `from`.
+         */
+        static uint64_t Between(uint64_t from, uint64_t to) { return to > from ? ToNanoseconds(to - from) : 0; }
+
+        /**
+         * \brief Returns true if the clock reads the TSC.
+         */
+        static bool UsesTsc() { return s_UseTsc; }
+
+        static uint64_t MonotonicNanoseconds() {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+        }
+
+    private:
+        static bool s_UseTsc;
+        static double s_NanosecondsPerTick;
+
+    };
+
+} // namespace cppserv
+
+#endif // __TSCCLOCK_H__
@@ -0,0 +1,126 @@
+#ifndef __DATAGRAMBATCH_H__
+#define __DATAGRAMBATCH_H__
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <string.h>
+#include <vector>
+
+namespace cppserv {
+
+    /**
+     * \brief A view of one datagram inside a DatagramBatch.
+     */
+    struct Datagram {
+        char* data;
+        size_t len;
+        struct sockaddr_storage* peer;
+        socklen_t peerLen;
+    };
+
+    /**
+     * \brief A fixed set of datagram slots that can be filled or flushed with a single syscall.
+     *
+     * All payload buffers and peer addresses live in storage owned by the batch, and the `mmsghdr`
+     * array is prepared once, so receiving and sending a batch does not allocate. Peer addresses
+     * are kept as raw `sockaddr_storage`, no name resolution takes place on the datagram path.
+     */
+    class DatagramBatch {
+    public:
+        /**
+         * \brief Creates a batch of `capacity` slots of `slotSize` bytes each.
+         *
+         * \param capacity The maximum number of datagrams in the batch.
+         * \param slotSize The maximum payload size of a single datagram.
+         */
+        DatagramBatch(size_t capacity, size_t slotSize)
+            : m_Capacity(capacity), m_SlotSize(slotSize), m_Count(0),
+              m_Storage(capacity * slotSize), m_Peers(capacity), m_IoVecs(capacity), m_Headers(capacity) {
+            for (size_t i = 0; i < capacity; i++) {
+                m_IoVecs[i].iov_base = m_Storage.data() + i * slotSize;
+                m_IoVecs[i].iov_len = slotSize;
+                memset(&m_Headers[i], 0, sizeof(m_Headers[i]));
+                m_Headers[i].msg_hdr.msg_name = &m_Peers[i];
+                m_Headers[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+                m_Headers[i].msg_hdr.msg_iov = &m_IoVecs[i];
+                m_Headers[i].msg_hdr.msg_iovlen = 1;
+            }
+        }
+
+        DatagramBatch(const DatagramBatch&) = delete;
+        DatagramBatch& operator=(const DatagramBatch&) = delete;
+
+        /**
+         * \brief Resets all slots so the batch can be passed to a receive call again.
+         */
+        void Reset() {
+            for (size_t i = 0; i < m_Capacity; i++) {
+                m_IoVecs[i].iov_len = m_SlotSize;
+                m_Headers[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+                m_Headers[i].msg_len = 0;
+            }
+            m_Count = 0;
+        }
+
+        /**
+         * \brief Appends a datagram to the batch.
+         *
+         * \param data The payload to copy into the next free slot.
+         * \param len The payload length, at most the slot size.
+         * \param peer The destination address.
+         * \param peerLen The length of the destination address.
+         * \return Returns true on success, false if the batch is full, the payload is too large or the
+         *         address length is invalid.
+         */
+        bool Push(const char* data, size_t len, const struct sockaddr_storage& peer, socklen_t peerLen) {
+            if (m_Count >= m_Capacity || len > m_SlotSize || peerLen > sizeof(struct sockaddr_storage)) {
+                return false;
+            }
+            memcpy(m_IoVecs[m_Count].iov_base, data, len);
+            m_IoVecs[m_Count].iov_len = len;
+            memcpy(&m_Peers[m_Count], &peer, peerLen);
+            m_Headers[m_Count].msg_hdr.msg_namelen = peerLen;
+            m_Count++;
+            return true;
+        }
+
+        Datagram At(size_t i) {
+            return Datagram{ (char*)m_IoVecs[i].iov_base, Length(i), &m_Peers[i], m_Headers[i].msg_hdr.msg_namelen };
+        }
+
+        size_t Length(size_t i) const { return m_IoVecs[i].iov_len; }
+
+        size_t Count() const { return m_Count; }
+        size_t Capacity() const { return m_Capacity; }
+        size_t SlotSize() const { return m_SlotSize; }
+        bool Empty() const { return m_Count == 0; }
+        bool Full() const { return m_Count == m_Capacity; }
+
+        /**
+         * \brief Marks the first `count` slots as filled by a receive call.
+         *
+         * \param count The number of datagrams that were received.
+         */
+        void Received(size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                m_IoVecs[i].iov_len = m_Headers[i].msg_len;
+            }
+            m_Count = count;
+        }
+
+        struct mmsghdr* Headers() { return m_Headers.data(); }
+
+    private:
+        size_t m_Capacity;
+        size_t m_SlotSize;
+        size_t m_Count;
+        std::vector<char> m_Storage;
+        std::vector<struct sockaddr_storage> m_Peers;
+        std::vector<struct iovec> m_IoVecs;
+        std::vector<struct mmsghdr> m_Headers;
+    };
+
+} // namespace cppserv
+
+
+#endif // __DATAGRAMBATCH_H__
@@ -0,0 +1,95 @@
+#include "DatagramServer.h"
+
+#include <sys/time.h>
+
+#include "../logger/Logger.h"
+
+namespace cppserv {
+
+    /**
+     * \brief How often a blocked shard wakes up to check for shutdown.
+     */
+    static constexpr long DATAGRAM_POLL_INTERVAL_US = 200000;
+
+    int DatagramServer::Init(const DatagramServerConfig& config, DatagramHandler handler) {
+        m_Config = config;
+        m_Handler = std::move(handler);
+        m_Stop = false;
+        if (m_Config.shards == 0) {
+            m_Config.shards = 1;
+        }
+        // recvmmsg with an empty batch returns 0 at once, the shard would spin
+        if (m_Config.batchSize == 0) {
+            m_Config.batchSize = 1;
+        }
+
+        CPPSERV_TRACE("Initializing datagram server with {} shards on {}:{}", m_Config.shards, m_Config.address, m_Config.port);
+
+        for (size_t i = 0; i < m_Config.shards; i++) {
+            Socket socket(AF_INET, SOCK_DGRAM, 0);
+
+            int one = 1;
+            socket.SocketSetOpt(SOL_SOCKET, SO_REUSEPORT, &one);
+            int rcvbuf = m_Config.receiveBufferBytes;
+            socket.SocketSetOpt(SOL_SOCKET, SO_RCVBUF, &rcvbuf);
+            struct timeval tv;
+            tv.tv_sec = 0;
+            tv.tv_usec = DATAGRAM_POLL_INTERVAL_US;
+            socket.SocketSetOpt(SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+            int status = socket.Bind(m_Config.address, m_Config.port);
+            if (status < 0) {
+                socket.Close();
+                Shutdown();
+                return status;
+            }
+            m_Sockets.push_back(socket);
+        }
+
+        for (size_t i = 0; i < m_Config.shards; i++) {
+            m_Threads.emplace_back([this, i] {
+                RunShard(i);
+            });
+        }
+        return 0;
+    }
+
+    void DatagramServer::RunShard(size_t index) {
+        Socket& socket = m_Sockets[index];
+        DatagramBatch received(m_Config.batchSize, m_Config.maxDatagramSize);
+        DatagramBatch replies(m_Config.batchSize, m_Config.maxDatagramSize);
+
+        while (!m_Stop.load(std::memory_order_relaxed)) {
+            int count = socket.SocketReadBatch(received);
+            if (count <= 0) {
+                continue;
+            }
+            m_Received.fetch_add((uint64_t)count, std::memory_order_relaxed);
+
+            m_Handler(received, replies);
+
+            if (!replies.Empty()) {
+                int sent = socket.SocketWriteBatch(replies);
+                if (sent > 0) {
+                    m_Sent.fetch_add((uint64_t)sent, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    void DatagramServer::Shutdown() {
+        CPPSERV_TRACE("Shutting down datagram server");
+
+        m_Stop = true;
+        for (auto& thread : m_Threads) {
+            thread.join();
+        }
+        m_Threads.clear();
+
+        for (auto& socket : m_Sockets) {
+            socket.Close();
+        }
+        m_Sockets.clear();
+    }
+
+} // namespace cppserv
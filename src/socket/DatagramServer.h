@@ -0,0 +1,81 @@
+#ifndef __DATAGRAMSERVER_H__
+#define __DATAGRAMSERVER_H__
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "../core/cppservcore.h"
+#include "Socket.h"
+
+namespace cppserv {
+
+    /**
+     * \brief Handles one batch of received datagrams.
+     *
+     * The first argument holds the received datagrams, replies can be pushed into the second batch,
+     * which is flushed with a single `sendmmsg` once the handler returns. The reply batch has the
+     * same capacity as the receive batch.
+     */
+    using DatagramHandler = std::function<void(DatagramBatch& received, DatagramBatch& replies)>;
+
+    struct DatagramServerConfig {
+        std::string address = "0.0.0.0";
+        std::string port;
+        size_t shards = std::thread::hardware_concurrency();
+        size_t batchSize = 64;
+        size_t maxDatagramSize = 2048;
+        int receiveBufferBytes = 4 * 1048576;
+    };
+
+    class DatagramServer {
+    public:
+        DatagramServer() {}
+        ~DatagramServer() {}
+
+        /**
+         * \brief Starts the datagram server.
+         *
+         * This function opens one UDP socket per shard, all bound to the same address with
+         * `SO_REUSEPORT`, so the kernel spreads incoming datagrams across the shards by flow hash.
+         * Every shard runs its own thread that receives and answers datagrams in batches.
+         *
+         * \param config The server configuration.
+         * \param handler The handler that is invoked for every received batch.
+         * \return Returns 0 on success, or a negative value indicating an error.
+         */
+        int Init(const DatagramServerConfig& config, DatagramHandler handler);
+
+        /**
+         * \brief Stops all shards and waits for their threads to finish.
+         */
+        void Shutdown();
+
+        /**
+         * \brief Returns the total number of datagrams received by all shards.
+         */
+        uint64_t GetReceivedCount() const { return m_Received.load(std::memory_order_relaxed); }
+
+        /**
+         * \brief Returns the total number of datagrams sent by all shards.
+         */
+        uint64_t GetSentCount() const { return m_Sent.load(std::memory_order_relaxed); }
+
+    private:
+        void RunShard(size_t index);
+
+    private:
+        DatagramServerConfig m_Config;
+        DatagramHandler m_Handler;
+        std::vector<Socket> m_Sockets;
+        std::vector<std::thread> m_Threads;
+        std::atomic<bool> m_Stop = false;
+        std::atomic<uint64_t> m_Received = 0;
+        std::atomic<uint64_t> m_Sent = 0;
+    };
+
+} // namespace cppserv
+
+
+#endif // __DATAGRAMSERVER_H__
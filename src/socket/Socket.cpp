@@ -8,16 +8,22 @@
 
 #include "Socket.h"
 
+#include <poll.h>
+#include <chrono>
+#include <linux/net_tstamp.h>
+
 #include "../logger/Logger.h"
+#include "../diagnostics/Probes.h"
 
 namespace cppserv {
 
-
-    Socket::Socket() {
-
+    Socket::Socket() : m_Socket(-1) {
+        memset(&m_AddressInfo, 0, sizeof m_AddressInfo);
+        memset(&m_AddressStorage, 0, sizeof m_AddressStorage);
     }
     Socket::Socket(int domain, int type, int protocol) {
         memset(&m_AddressInfo, 0, sizeof m_AddressInfo);
+        memset(&m_AddressStorage, 0, sizeof m_AddressStorage);
         m_Socket = socket(domain, type, protocol);
         if (m_Socket < 0) {
             CPPSERV_ERROR("opening socket error: {}", gai_strerror(errno));
@@ -30,6 +36,34 @@ namespace cppserv {
         m_Address = "";
     }
 
+    Socket::Socket(int handle) {
+        memset(&m_AddressInfo, 0, sizeof m_AddressInfo);
+        memset(&m_AddressStorage, 0, sizeof m_AddressStorage);
+        m_Socket = handle;
+        m_Port = "";
+        m_Address = "";
+    }
+
+    Socket::Socket(const Socket& other) {
+        *this = other;
+    }
+
+    Socket& Socket::operator=(const Socket& other) {
+        if (this == &other) {
+            return *this;
+        }
+        m_Socket = other.m_Socket;
+        m_Address = other.m_Address;
+        m_Port = other.m_Port;
+        m_AddressInfo = other.m_AddressInfo;
+        m_AddressStorage = other.m_AddressStorage;
+        // ai_addr points into the storage of the socket it was resolved for
+        if (other.m_AddressInfo.ai_addr == (const struct sockaddr*)&other.m_AddressStorage) {
+            m_AddressInfo.ai_addr = (struct sockaddr*)&m_AddressStorage;
+        }
+        return *this;
+    }
+
     int Socket::Bind(std::string ip, std::string port) {
         if (m_AddressInfo.ai_family == AF_UNIX) {
 
@@ -54,7 +88,8 @@ namespace cppserv {
             return status;
         }
         m_AddressInfo.ai_addrlen = res->ai_addrlen;
-        m_AddressInfo.ai_addr = res->ai_addr;
+        memcpy(&m_AddressStorage, res->ai_addr, res->ai_addrlen);
+        m_AddressInfo.ai_addr = (struct sockaddr*)&m_AddressStorage;
         freeaddrinfo(res);
         status = ::bind(m_Socket, m_AddressInfo.ai_addr, m_AddressInfo.ai_addrlen);
         if (status < 0) {
@@ -88,7 +123,8 @@ namespace cppserv {
             return status;
         }
         m_AddressInfo.ai_addrlen = res->ai_addrlen;
-        m_AddressInfo.ai_addr = res->ai_addr;
+        memcpy(&m_AddressStorage, res->ai_addr, res->ai_addrlen);
+        m_AddressInfo.ai_addr = (struct sockaddr*)&m_AddressStorage;
         freeaddrinfo(res);
         status = ::connect(m_Socket, m_AddressInfo.ai_addr, m_AddressInfo.ai_addrlen);
         if (status < 0) {
@@ -112,6 +148,7 @@ namespace cppserv {
         socklen_t addr_size;
         addr_size = sizeof their_addr;
         int newsock = ::accept(m_Socket, (struct sockaddr*)&their_addr, &addr_size);
+        CPPSERV_PROBE2(accept, m_Socket, newsock);
         if (newsock < 0) {
             CPPSERV_ERROR("accept error: {}", gai_strerror(errno));
         }
@@ -126,10 +163,37 @@ namespace cppserv {
         }
         newSocket->m_Address = host;
         newSocket->m_AddressInfo.ai_family = their_addr.ss_family;
-        newSocket->m_AddressInfo.ai_addr = (struct sockaddr*)&their_addr;
+        memcpy(&newSocket->m_AddressStorage, &their_addr, addr_size);
+        newSocket->m_AddressInfo.ai_addr = (struct sockaddr*)&newSocket->m_AddressStorage;
+        newSocket->m_AddressInfo.ai_addrlen = addr_size;
         std::cout << "Connection from: " << host << std::endl;
         return newSocket;
     }
+    int Socket::AcceptHandle(struct sockaddr_storage& peer, socklen_t& peerLen, int flags) {
+        peerLen = sizeof(peer);
+        int newsock = ::accept4(m_Socket, (struct sockaddr*)&peer, &peerLen, flags);
+        CPPSERV_PROBE2(accept, m_Socket, newsock);
+        if (newsock < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            CPPSERV_ERROR("accept error: {}", strerror(errno));
+        }
+        return newsock;
+    }
+    int Socket::SocketWrite(const char* buf, size_t len) {
+        int status = (int)send(m_Socket, buf, len, MSG_NOSIGNAL);
+        CPPSERV_PROBE3(write, m_Socket, len, status);
+        if (status < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            CPPSERV_ERROR("write error: {}", strerror(errno));
+        }
+        return status;
+    }
+    int Socket::SocketRead(char* buf, size_t len) {
+        int status = (int)recv(m_Socket, buf, len, 0);
+        CPPSERV_PROBE3(read, m_Socket, len, status);
+        if (status < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            CPPSERV_ERROR("read error: {}", strerror(errno));
+        }
+        return status;
+    }
     int Socket::SocketWrite(std::string msg) {
         const char* buf = msg.c_str();
         int len = (int)strlen(buf);
@@ -156,6 +220,76 @@ namespace cppserv {
         buf = std::string(buffer);
         return status;
     }
+    int Socket::SocketPoll(short events, int milliseconds) {
+        struct pollfd pfd;
+        pfd.fd = m_Socket;
+        pfd.events = events;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+        int timeout = milliseconds;
+        while (true) {
+            pfd.revents = 0;
+            int count = ::poll(&pfd, 1, timeout);
+            if (count >= 0 || errno != EINTR) {
+                return count;
+            }
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            timeout = left.count() > 0 ? (int)left.count() : 0;
+        }
+    }
+    int Socket::SocketSafeRead(char* buf, size_t len, int seconds) {
+        int count = SocketPoll(POLLIN, seconds * 1000);
+        if (count < 1) {
+            if (count < 0) {
+                CPPSERV_ERROR("poll error: {}", strerror(errno));
+            }
+            return -1;
+        }
+        return SocketRead(buf, len);
+    }
+    int Socket::SocketSafeReadTimestamped(char* buf, size_t len, int seconds, uint64_t& kernelNs) {
+        kernelNs = 0;
+        int count = SocketPoll(POLLIN, seconds * 1000);
+        if (count < 1) {
+            if (count < 0) {
+                CPPSERV_ERROR("poll error: {}", strerror(errno));
+            }
+            return -1;
+        }
+
+        struct iovec iov = { buf, len };
+        alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(struct timespec) * 3)];
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        int status = (int)recvmsg(m_Socket, &message, 0);
+        CPPSERV_PROBE3(read, m_Socket, len, status);
+        if (status < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                CPPSERV_ERROR("recvmsg error: {}", strerror(errno));
+            }
+            return status;
+        }
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPING) {
+                // software, deprecated and raw hardware timestamp; only the first is requested
+                struct timespec stamps[3];
+                memcpy(stamps, CMSG_DATA(cmsg), sizeof(stamps));
+                kernelNs = (uint64_t)stamps[0].tv_sec * 1000000000ull + (uint64_t)stamps[0].tv_nsec;
+            }
+        }
+        return status;
+    }
+    int Socket::EnableReceiveTimestamps() {
+        int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        int status = setsockopt(m_Socket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags));
+        if (status < 0) {
+            CPPSERV_ERROR("setsockopt error: {}", strerror(errno));
+        }
+        return status;
+    }
     int Socket::SocketRead(std::string& buf, int len) {
         char buffer[len];
         bzero(buffer, len);
@@ -169,55 +303,90 @@ namespace cppserv {
     int Socket::SocketWriteTo(std::string msg, std::string ip, std::string port) {
         const char* buf = msg.c_str();
         int len = (int)strlen(buf);
-        m_Address = ip;
-        this->m_Port = port;
-        struct addrinfo* res;
         int status;
-        if ((status = getaddrinfo(ip.c_str(), port.c_str(), &m_AddressInfo, &res)) != 0) {
-            CPPSERV_ERROR("getaddrinfo error: {}", gai_strerror(errno));
-            return status;
+        // only resolve when the destination changes
+        if (m_AddressInfo.ai_addr == nullptr || ip != m_Address || port != m_Port) {
+            m_Address = ip;
+            this->m_Port = port;
+            struct addrinfo* res;
+            if ((status = getaddrinfo(ip.c_str(), port.c_str(), &m_AddressInfo, &res)) != 0) {
+                CPPSERV_ERROR("getaddrinfo error: {}", gai_strerror(errno));
+                return status;
+            }
+            m_AddressInfo.ai_addrlen = res->ai_addrlen;
+            memcpy(&m_AddressStorage, res->ai_addr, res->ai_addrlen);
+            m_AddressInfo.ai_addr = (struct sockaddr*)&m_AddressStorage;
+            freeaddrinfo(res);
         }
-        m_AddressInfo.ai_addrlen = res->ai_addrlen;
-        m_AddressInfo.ai_addr = res->ai_addr;
-        freeaddrinfo(res);
         status = (int)sendto(m_Socket, buf, len, 0, m_AddressInfo.ai_addr, m_AddressInfo.ai_addrlen);
         if (status < 0) {
             CPPSERV_ERROR("writeTo error: {}", gai_strerror(errno));
         }
         return status;
     }
-    int Socket::SocketReadFrom(std::string& buf, int len, std::string ip, std::string port) {
-        char buffer[len];
-        bzero(buffer, len);
-        struct addrinfo* res;
-        int status;
-        if ((status = getaddrinfo(ip.c_str(), port.c_str(), &m_AddressInfo, &res)) != 0) {
-            CPPSERV_ERROR("getaddrinfo error: {}", gai_strerror(errno));
-            return status;
+    int Socket::SocketReadFrom(std::string& buf, int len) {
+        struct sockaddr_storage peer;
+        socklen_t peerLen;
+        buf.resize(len);
+        int status = SocketReadFrom(buf.data(), len, peer, peerLen);
+        buf.resize(status > 0 ? status : 0);
+        return status;
+    }
+    int Socket::SocketWriteTo(const char* buf, size_t len, const struct sockaddr_storage& peer, socklen_t peerLen) {
+        int status = (int)sendto(m_Socket, buf, len, 0, (const struct sockaddr*)&peer, peerLen);
+        if (status < 0) {
+            CPPSERV_ERROR("writeTo error: {}", strerror(errno));
         }
-        m_AddressInfo.ai_addrlen = res->ai_addrlen;
-        m_AddressInfo.ai_addr = res->ai_addr;
-        freeaddrinfo(res);
-        status = (int)recvfrom(m_Socket, buffer, len - 1, 0, m_AddressInfo.ai_addr, &m_AddressInfo.ai_addrlen);
+        return status;
+    }
+    int Socket::SocketReadFrom(char* buf, size_t len, struct sockaddr_storage& peer, socklen_t& peerLen) {
+        peerLen = sizeof(peer);
+        int status = (int)recvfrom(m_Socket, buf, len, 0, (struct sockaddr*)&peer, &peerLen);
         if (status < 0) {
-            CPPSERV_ERROR("readFrom error: {}", gai_strerror(errno));
+            CPPSERV_ERROR("readFrom error: {}", strerror(errno));
         }
-        buf = std::string(buffer);
         return status;
     }
+    int Socket::SocketReadBatch(DatagramBatch& batch, int flags) {
+        batch.Reset();
+        int status = recvmmsg(m_Socket, batch.Headers(), (unsigned int)batch.Capacity(), flags, NULL);
+        if (status < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                CPPSERV_ERROR("readBatch error: {}", strerror(errno));
+            }
+            return status;
+        }
+        batch.Received((size_t)status);
+        return status;
+    }
+    int Socket::SocketWriteBatch(DatagramBatch& batch) {
+        size_t sent = 0;
+        while (sent < batch.Count()) {
+            int status = sendmmsg(m_Socket, batch.Headers() + sent, (unsigned int)(batch.Count() - sent), 0);
+            if (status < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                CPPSERV_ERROR("writeBatch error: {}", strerror(errno));
+                batch.Reset();
+                return sent > 0 ? (int)sent : status;
+            }
+            sent += (size_t)status;
+        }
+        batch.Reset();
+        return (int)sent;
+    }
 
-    int Socket::SocketSetOpt(int level, int optname, void* optval) {
-        unsigned int len = sizeof(optval);
-        int status = ::setsockopt(m_Socket, level, optname, optval, len);
+    int Socket::SocketSetOpt(int level, int optname, void* optval, socklen_t optlen) {
+        int status = ::setsockopt(m_Socket, level, optname, optval, optlen);
         if (status < 0) {
             CPPSERV_ERROR("socket_set_opt error: {}", gai_strerror(errno));
         }
         return status;
     }
 
-    int Socket::SocketGetOpt(int level, int optname, void* optval) {
-        unsigned int len = sizeof(optval);
-        int status = ::getsockopt(m_Socket, level, optname, optval, &len);
+    int Socket::SocketGetOpt(int level, int optname, void* optval, socklen_t& optlen) {
+        int status = ::getsockopt(m_Socket, level, optname, optval, &optlen);
         if (status < 0) {
             CPPSERV_ERROR("socket_get_opt error: {}", gai_strerror(errno));
         }
@@ -16,6 +16,7 @@
 #include <errno.h>
 
 #include "../core/cppservcore.h"
+#include "DatagramBatch.h"
 
 namespace cppserv {
 
@@ -24,6 +25,19 @@ namespace cppserv {
         Socket();
         Socket(int domain, int type, int protocol);
 
+        /**
+         * \brief Wraps an already connected socket handle, e.g. one returned by `AcceptHandle`.
+         *
+         * \param handle The file descriptor of the socket.
+         */
+        explicit Socket(int handle);
+
+        /**
+         * \brief Copies the handle and the address; the copy points at its own address storage.
+         */
+        Socket(const Socket& other);
+        Socket& operator=(const Socket& other);
+
         /**
          * \brief Binds the socket to the specified IP address and port.
          *
@@ -69,6 +83,20 @@ namespace cppserv {
          */
         Ref<Socket> Accept();
 
+        /**
+         * \brief Accepts an incoming connection and returns its raw handle.
+         *
+         * Unlike `Accept`, this function does not allocate and does not resolve the peer name. On a
+         * non-blocking listener it returns -1 with `errno` set to EAGAIN when no connection is pending,
+         * which is not logged as an error.
+         *
+         * \param peer Reference to the storage that receives the peer address.
+         * \param peerLen Reference that receives the length of the peer address.
+         * \param flags Flags passed to `accept4`, e.g. SOCK_NONBLOCK | SOCK_CLOEXEC.
+         * \return Returns the handle of the accepted connection, or a negative value indicating an error.
+         */
+        int AcceptHandle(struct sockaddr_storage& peer, socklen_t& peerLen, int flags = 0);
+
         /**
          * \brief Writes data to the socket.
          *
@@ -79,6 +107,17 @@ namespace cppserv {
          */
         int SocketWrite(std::string msg);
 
+        /**
+         * \brief Writes raw bytes to the socket.
+         *
+         * On a non-blocking socket EAGAIN is returned as -1 without being logged.
+         *
+         * \param buf Pointer to the data to write.
+         * \param len The number of bytes to write.
+         * \return Returns the number of bytes written on success, or a negative value indicating an error.
+         */
+        int SocketWrite(const char* buf, size_t len);
+
         /**
          * \brief Reads data from the socket.
          *
@@ -90,6 +129,17 @@ namespace cppserv {
          */
         int SocketRead(std::string& buf, int len);
 
+        /**
+         * \brief Reads raw bytes from the socket into a caller provided buffer.
+         *
+         * On a non-blocking socket EAGAIN is returned as -1 without being logged.
+         *
+         * \param buf Pointer to the buffer where the received data will be stored.
+         * \param len The size of the buffer.
+         * \return Returns the number of bytes received, 0 if the peer closed the connection, or a negative value indicating an error.
+         */
+        int SocketRead(char* buf, size_t len);
+
         /**
          * \brief Reads data from the socket with a timeout.
          *
@@ -102,6 +152,53 @@ namespace cppserv {
          */
         int SocketSafeRead(std::string& buf, int len, int seconds);
 
+        /**
+         * \brief Reads raw bytes from the socket with a timeout.
+         *
+         * Unlike the string overload this function neither allocates nor copies.
+         *
+         * \param buf Pointer to the buffer where the received data will be stored.
+         * \param len The size of the buffer.
+         * \param seconds The timeout duration in seconds.
+         * \return Returns the number of bytes received, 0 if the peer closed the connection, or a negative value on timeout or error.
+         */
+        int SocketSafeRead(char* buf, size_t len, int seconds);
+
+        /**
+         * \brief Reads raw bytes from the socket with a timeout and returns when the kernel received them.
+         *
+         * Requires `EnableReceiveTimestamps`. For TCP the timestamp is the one of the last segment the
+         * read consumed.
+         *
+         * \param buf Pointer to the buffer where the received data will be stored.
+         * \param len The size of the buffer.
+         * \param seconds The timeout duration in seconds.
+         * \param kernelNs Receives the CLOCK_REALTIME receive timestamp in nanoseconds, 0 if none was delivered.
+         * \return Returns the number of bytes received, 0 if the peer closed the connection, or a negative value on timeout or error.
+         */
+        int SocketSafeReadTimestamped(char* buf, size_t len, int seconds, uint64_t& kernelNs);
+
+        /**
+         * \brief Waits until the socket is ready for the given events.
+         *
+         * A signal that interrupts the wait (e.g. SIGPROF of the sampling profiler) restarts it with the
+         * remaining time.
+         *
+         * \param events The poll events to wait for, e.g. POLLIN or POLLOUT.
+         * \param milliseconds The timeout in milliseconds.
+         * \return Returns 1 if the socket is ready, 0 on timeout, or a negative value indicating an error.
+         */
+        int SocketPoll(short events, int milliseconds);
+
+        /**
+         * \brief Enables software receive timestamps (SO_TIMESTAMPING), read by `SocketSafeReadTimestamped`.
+         *
+         * Set on a listening socket, the accepted sockets inherit it.
+         *
+         * \return Returns 0 on success, or a negative value indicating an error.
+         */
+        int EnableReceiveTimestamps();
+
         /**
          * \brief Writes data to a specified IP address and port.
          *
@@ -115,17 +212,60 @@ namespace cppserv {
         int SocketWriteTo(std::string msg, std::string ip, std::string port);
 
         /**
-         * \brief Reads data from a specified IP address and port.
+         * \brief Reads the next datagram from any sender.
          *
-         * This function reads data from the specified IP address and port into the specified buffer.
+         * The source address is not resolved or filtered; use the `sockaddr_storage` overload to learn
+         * the sender.
          *
          * \param buf Reference to a string where the received data will be stored.
          * \param len The maximum number of bytes to read into the buffer.
-         * \param ip The IP address to read from.
-         * \param port The port number or service name to read from.
          * \return Returns the number of bytes received on success, or a negative value indicating an error.
          */
-        int SocketReadFrom(std::string& buf, int len, std::string ip, std::string port);
+        int SocketReadFrom(std::string& buf, int len);
+
+        /**
+         * \brief Writes a datagram to a raw peer address.
+         *
+         * \param buf Pointer to the data to send.
+         * \param len The number of bytes to send.
+         * \param peer The destination address.
+         * \param peerLen The length of the destination address.
+         * \return Returns the number of bytes written on success, or a negative value indicating an error.
+         */
+        int SocketWriteTo(const char* buf, size_t len, const struct sockaddr_storage& peer, socklen_t peerLen);
+
+        /**
+         * \brief Reads a datagram and its raw source address.
+         *
+         * \param buf Pointer to the buffer where the datagram will be stored.
+         * \param len The size of the buffer.
+         * \param peer Reference to the storage that receives the source address.
+         * \param peerLen Reference that receives the length of the source address.
+         * \return Returns the number of bytes received on success, or a negative value indicating an error.
+         */
+        int SocketReadFrom(char* buf, size_t len, struct sockaddr_storage& peer, socklen_t& peerLen);
+
+        /**
+         * \brief Receives up to `batch.Capacity()` datagrams with a single `recvmmsg` call.
+         *
+         * The batch is reset before receiving. With the default flags the call blocks until at least one
+         * datagram is available and then returns whatever else is already queued.
+         *
+         * \param batch The batch to fill.
+         * \param flags Flags passed to `recvmmsg`.
+         * \return Returns the number of datagrams received, or a negative value indicating an error.
+         */
+        int SocketReadBatch(DatagramBatch& batch, int flags = MSG_WAITFORONE);
+
+        /**
+         * \brief Sends all datagrams of a batch using as few `sendmmsg` calls as possible.
+         *
+         * The batch is reset afterwards, whether or not all datagrams could be sent.
+         *
+         * \param batch The batch to flush.
+         * \return Returns the number of datagrams sent, or a negative value indicating an error.
+         */
+        int SocketWriteBatch(DatagramBatch& batch);
 
         /**
          * \brief Sets options on the socket.
@@ -135,9 +275,10 @@ namespace cppserv {
          * \param level The protocol level at which the option resides.
          * \param optname The socket option to set.
          * \param optval A pointer to the value for the option being set.
+         * \param optlen The size of the value pointed to by `optval`.
          * \return Returns 0 on success, or a negative value indicating an error.
          */
-        int SocketSetOpt(int level, int optname, void* optval);
+        int SocketSetOpt(int level, int optname, void* optval, socklen_t optlen = sizeof(int));
 
         /**
          * \brief Gets options from the socket.
@@ -147,9 +288,12 @@ namespace cppserv {
          * \param level The protocol level at which the option resides.
          * \param optname The socket option to retrieve.
          * \param optval A pointer to the buffer where the option value will be stored.
+         * \param optlen The size of the buffer pointed to by `optval`, receives the size of the returned
+         *               value. A kernel that returns a shorter value (e.g. an older `struct tcp_info`)
+         *               leaves the rest of the buffer untouched.
          * \return Returns 0 on success, or a negative value indicating an error.
          */
-        int SocketGetOpt(int level, int optname, void* optval);
+        int SocketGetOpt(int level, int optname, void* optval, socklen_t& optlen);
 
         /**
          * \brief Sets the socket to blocking mode.
@@ -215,11 +359,24 @@ namespace cppserv {
          */
         static std::string IpFromHostName(std::string hostname);
 
+        /**
+         * \brief Returns the file descriptor of the socket.
+         *
+         * \return Returns the native socket handle.
+         */
+        int GetHandle() const { return m_Socket; }
+
+        /**
+         * \brief Returns the numeric address of the peer (accepted sockets) or the bound address.
+         */
+        const std::string& GetAddress() const { return m_Address; }
+
     private:
         int m_Socket;
         std::string m_Address;
         std::string m_Port;
         struct addrinfo m_AddressInfo;
+        struct sockaddr_storage m_AddressStorage;
     };
 }
 #endif // __SOCKET_H__
\ No newline at end of file
@@ -1,18 +1,27 @@
 #include "Threadpool.h"
 
+#include <algorithm>
+#include <pthread.h>
+#include <sched.h>
+
 #include "../logger/Logger.h"
+#include "../diagnostics/Probes.h"
 
 namespace cppserv {
 
 
-    void ThreadPool::Init(const size_t numThreads) {
+    void ThreadPool::Init(const size_t numThreads, bool pin) {
         CPPSERV_TRACE("Initializing thread pool with {} threads", numThreads);
+        size_t cpus = std::max<size_t>(std::thread::hardware_concurrency(), 1);
         for (size_t i = 0; i < numThreads; ++i) {
-            m_Threads.emplace_back([this] {
+            m_Threads.emplace_back([this, i] {
+                if (m_ThreadStart) {
+                    m_ThreadStart(i);
+                }
                 while (true) {
-                    std::function<void()> task;
+                    QueuedTask queued;
                     {
-                        std::unique_lock<std::mutex> lock(m_QueueMutex);
+                        std::unique_lock<InstrumentedMutex> lock(m_QueueMutex);
 
                         m_CV.wait(lock, [this] {
                             return !m_Tasks.empty() || m_Stop;
@@ -22,21 +31,43 @@ namespace cppserv {
                             return;
                         }
 
-                        task = move(m_Tasks.front());
+                        queued = std::move(m_Tasks.front());
                         m_Tasks.pop();
+                        m_QueueDepth.store(m_Tasks.size(), std::memory_order_relaxed);
                     }
 
-                    task();
+                    uint64_t started = TscClock::Now();
+                    uint64_t waited = TscClock::Between(queued.submitted, started);
+                    if (m_WaitTime != nullptr) {
+                        m_WaitTime->Record(waited);
+                    }
+                    CPPSERV_PROBE1(task_start, waited);
+                    queued.task();
+                    if (CPPSERV_PROBE_ENABLED(task_end)) {
+                        CPPSERV_PROBE1(task_end, TscClock::Between(started, TscClock::Now()));
+                    }
                 }
                 });
+
+            if (pin) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(i % cpus, &set);
+                int status = pthread_setaffinity_np(m_Threads.back().native_handle(), sizeof(set), &set);
+                if (status != 0) {
+                    CPPSERV_ERROR("pthread_setaffinity_np error: {}", strerror(status));
+                }
+            }
         }
     }
 
 
     void ThreadPool::Submit(std::function<void()> task) {
         {
-            std::unique_lock<std::mutex> lock(m_QueueMutex);
-            m_Tasks.emplace(std::move(task));
+            std::unique_lock<InstrumentedMutex> lock(m_QueueMutex);
+            m_Tasks.push({ std::move(task), TscClock::Now() });
+            m_QueueDepth.store(m_Tasks.size(), std::memory_order_relaxed);
+            CPPSERV_PROBE1(submit, m_Tasks.size());
         }
         m_CV.notify_one();
     }
@@ -46,7 +77,7 @@ namespace cppserv {
         CPPSERV_TRACE("Shutting down thread pool");
 
         {
-            std::unique_lock<std::mutex> lock(m_QueueMutex);
+            std::unique_lock<InstrumentedMutex> lock(m_QueueMutex);
             m_Stop = true;
         }
 
@@ -62,7 +93,7 @@ namespace cppserv {
         CPPSERV_TRACE("Terminating thread pool");
 
         {
-            std::unique_lock<std::mutex> lock(m_QueueMutex);
+            std::unique_lock<InstrumentedMutex> lock(m_QueueMutex);
             m_Stop = true;
         }
 
@@ -7,9 +7,13 @@
 #include <mutex> 
 #include <queue> 
 #include <thread> 
+#include <atomic>
 
 #include "../core/cppservcore.h"
 #include "../socket/Socket.h"
+#include "../metrics/Metrics.h"
+#include "../metrics/TscClock.h"
+#include "../diagnostics/InstrumentedMutex.h"
 
 namespace cppserv {
     class ThreadPool {
@@ -23,8 +27,9 @@ namespace cppserv {
          * This function initializes the thread pool with the specified number of threads.
          *
          * \param numThreads The number of threads to create in the thread pool.
+         * \param pin Pins thread i to CPU i (modulo the number of CPUs), e.g. to measure scaling per core.
          */
-        void Init(const size_t numThreads = std::thread::hardware_concurrency());
+        void Init(const size_t numThreads = std::thread::hardware_concurrency(), bool pin = false);
 
         /**
          * \brief Submits a task to the thread pool for execution.
@@ -49,11 +54,39 @@ namespace cppserv {
          */
         void Terminate();
 
+        /**
+         * \brief Returns the number of tasks that wait for a thread.
+         */
+        size_t GetQueueDepth() const { return m_QueueDepth.load(std::memory_order_relaxed); }
+
+        /**
+         * \brief Records the time every task waited in the queue, in nanoseconds.
+         *
+         * \param histogram The histogram, must outlive the pool. nullptr stops recording.
+         */
+        void SetWaitTimeHistogram(Histogram* histogram) { m_WaitTime = histogram; }
+
+        /**
+         * \brief Sets a function every worker thread runs once before it takes tasks, e.g. to register it with a profiler.
+         *
+         * \param hook The function, gets the index of the worker. Must be set before `Init`.
+         */
+        void SetThreadStartHook(std::function<void(size_t)> hook) { m_ThreadStart = std::move(hook); }
+
+    private:
+        struct QueuedTask {
+            std::function<void()> task;
+            uint64_t submitted;
+        };
+
     private:
         std::vector<std::thread> m_Threads;
-        std::queue<std::function<void()> > m_Tasks;
-        std::mutex m_QueueMutex;
-        std::condition_variable m_CV;
+        std::queue<QueuedTask> m_Tasks;
+        std::atomic<size_t> m_QueueDepth = 0;
+        Histogram* m_WaitTime = nullptr;
+        std::function<void(size_t)> m_ThreadStart;
+        InstrumentedMutex m_QueueMutex{ "threadpool_queue" };
+        std::condition_variable_any m_CV;
         bool m_Stop = false;
     };
 
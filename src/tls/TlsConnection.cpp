@@ -0,0 +1,177 @@
+#include "TlsConnection.h"
+#include "../diagnostics/Probes.h"
+
+#include <poll.h>
+#include <chrono>
+
+#include <openssl/err.h>
+
+#include "../logger/Logger.h"
+
+namespace cppserv {
+
+    /**
+     * \brief Chunk size of the user-space sendfile fallback, one maximum sized TLS record.
+     */
+    static constexpr size_t TLS_SENDFILE_CHUNK = 16384;
+
+    TlsConnection::TlsConnection(TlsContext& context, Socket& socket) : m_Socket(socket) {
+        m_Ssl = SSL_new(context.GetNative());
+        if (m_Ssl == nullptr) {
+            TlsContext::LogErrors("tls session");
+            return;
+        }
+        SSL_set_fd(m_Ssl, m_Socket.GetHandle());
+    }
+
+    TlsConnection::~TlsConnection() {
+        if (m_Ssl != nullptr) {
+            SSL_free(m_Ssl);
+        }
+    }
+
+    int TlsConnection::Handshake(int seconds) {
+        if (m_Ssl == nullptr) {
+            return -1;
+        }
+        // non-blocking for the duration of the handshake, so a peer that never sends its hello cannot hold the thread
+        if (m_Socket.SetNonBlocking() < 0) {
+            return -1;
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+        int result = -1;
+        while (true) {
+            int status = SSL_accept(m_Ssl);
+            if (status == 1) {
+                result = 0;
+                break;
+            }
+            int error = SSL_get_error(m_Ssl, status);
+            if (error != SSL_ERROR_WANT_READ && error != SSL_ERROR_WANT_WRITE) {
+                TlsContext::LogErrors("tls handshake");
+                break;
+            }
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (left.count() <= 0 || m_Socket.SocketPoll(error == SSL_ERROR_WANT_READ ? POLLIN : POLLOUT, (int)left.count()) < 1) {
+                CPPSERV_WARN("tls handshake error: no progress within {}s", seconds);
+                break;
+            }
+        }
+        if (m_Socket.SetBlocking() < 0) {
+            return -1;
+        }
+        if (result == 0) {
+            CPPSERV_TRACE("TLS handshake done ({}, resumed: {}, ktls tx: {}, ktls rx: {})",
+                SSL_get_version(m_Ssl), IsSessionReused(), IsKtlsSend(), IsKtlsReceive());
+        }
+        return result;
+    }
+
+    int TlsConnection::Read(std::string& buf, int len) {
+        buf.resize(len);
+        int status = Read(buf.data(), (size_t)len);
+        buf.resize(status > 0 ? status : 0);
+        return status;
+    }
+
+    int TlsConnection::Read(char* buf, size_t len) {
+        size_t received = 0;
+        int status = SSL_read_ex(m_Ssl, buf, len, &received);
+        int result = (int)received;
+        if (status != 1) {
+            if (SSL_get_error(m_Ssl, status) == SSL_ERROR_ZERO_RETURN) {
+                result = 0;
+            } else {
+                TlsContext::LogErrors("tls read");
+                result = -1;
+            }
+        }
+        CPPSERV_PROBE3(read, m_Socket.GetHandle(), len, result);
+        return result;
+    }
+
+    int TlsConnection::SafeRead(std::string& buf, int len, int seconds) {
+        buf.resize(len);
+        int status = SafeRead(buf.data(), (size_t)len, seconds);
+        buf.resize(status > 0 ? status : 0);
+        return status;
+    }
+
+    int TlsConnection::SafeRead(char* buf, size_t len, int seconds) {
+        // data that is already decrypted inside OpenSSL is not visible to poll
+        if (SSL_pending(m_Ssl) == 0 && m_Socket.SocketPoll(POLLIN, seconds * 1000) < 1) {
+            return -1;
+        }
+        return Read(buf, len);
+    }
+
+    int TlsConnection::Write(const std::string& msg) {
+        return Write(msg.data(), msg.size());
+    }
+
+    int TlsConnection::Write(const char* buf, size_t len) {
+        size_t written = 0;
+        int status = SSL_write_ex(m_Ssl, buf, len, &written);
+        int result = (int)written;
+        if (status != 1) {
+            TlsContext::LogErrors("tls write");
+            result = -1;
+        }
+        CPPSERV_PROBE3(write, m_Socket.GetHandle(), len, result);
+        return result;
+    }
+
+    long TlsConnection::SendFile(int fd, off_t offset, size_t size) {
+        if (IsKtlsSend()) {
+            size_t sent = 0;
+            while (sent < size) {
+                ossl_ssize_t status = SSL_sendfile(m_Ssl, fd, offset + (off_t)sent, size - sent, 0);
+                if (status <= 0) {
+                    TlsContext::LogErrors("tls sendfile");
+                    return sent > 0 ? (long)sent : -1;
+                }
+                sent += (size_t)status;
+            }
+            return (long)sent;
+        }
+
+        char chunk[TLS_SENDFILE_CHUNK];
+        size_t sent = 0;
+        while (sent < size) {
+            size_t want = size - sent < sizeof(chunk) ? size - sent : sizeof(chunk);
+            ssize_t got = pread(fd, chunk, want, offset + (off_t)sent);
+            if (got <= 0) {
+                if (got < 0) {
+                    CPPSERV_ERROR("tls sendfile read error: {}", strerror(errno));
+                }
+                break;
+            }
+            size_t written = 0;
+            if (SSL_write_ex(m_Ssl, chunk, (size_t)got, &written) != 1) {
+                TlsContext::LogErrors("tls sendfile");
+                return sent > 0 ? (long)sent : -1;
+            }
+            sent += written;
+        }
+        return (long)sent;
+    }
+
+    void TlsConnection::Shutdown() {
+        if (m_Ssl != nullptr) {
+            SSL_shutdown(m_Ssl);
+        }
+    }
+
+    bool TlsConnection::IsKtlsSend() const {
+        return m_Ssl != nullptr && BIO_get_ktls_send(SSL_get_wbio(m_Ssl));
+    }
+
+    bool TlsConnection::IsKtlsReceive() const {
+        return m_Ssl != nullptr && BIO_get_ktls_recv(SSL_get_rbio(m_Ssl));
+    }
+
+    bool TlsConnection::IsSessionReused() const {
+        return m_Ssl != nullptr && SSL_session_reused(m_Ssl);
+    }
+
+} // namespace cppserv
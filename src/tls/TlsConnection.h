@@ -0,0 +1,127 @@
+#ifndef __TLSCONNECTION_H__
+#define __TLSCONNECTION_H__
+
+#include <string>
+#include <sys/types.h>
+
+#include <openssl/ssl.h>
+
+#include "../core/cppservcore.h"
+#include "../socket/Socket.h"
+#include "../transport/Transport.h"
+#include "TlsContext.h"
+
+namespace cppserv {
+
+    class TlsConnection : public Transport {
+    public:
+        /**
+         * \brief Creates a server side TLS session on top of an accepted socket.
+         *
+         * \param context The TLS context of the listener.
+         * \param socket The accepted, blocking socket.
+         */
+        TlsConnection(TlsContext& context, Socket& socket);
+        ~TlsConnection();
+
+        TlsConnection(const TlsConnection&) = delete;
+        TlsConnection& operator=(const TlsConnection&) = delete;
+
+        /**
+         * \brief Performs the server side TLS handshake.
+         *
+         * The socket is switched to non-blocking mode while the handshake runs and back afterwards, so the
+         * whole handshake is bounded by the timeout. After a successful handshake the record layer may have
+         * been moved into the kernel, see `IsKtlsSend` and `IsKtlsReceive`.
+         *
+         * \param seconds The time the peer has to complete the handshake.
+         * \return Returns 0 on success, or a negative value on timeout or error.
+         */
+        int Handshake(int seconds);
+
+        /**
+         * \brief Reads decrypted application data.
+         *
+         * \param buf Reference to a string where the received data will be stored.
+         * \param len The maximum number of bytes to read.
+         * \return Returns the number of bytes received, 0 if the peer closed the session, or a negative value indicating an error.
+         */
+        int Read(std::string& buf, int len);
+
+        /**
+         * \brief Reads decrypted application data with a timeout.
+         *
+         * \param buf Reference to a string where the received data will be stored.
+         * \param len The maximum number of bytes to read.
+         * \param seconds The timeout duration in seconds.
+         * \return Returns the number of bytes received, or a negative value on timeout or error.
+         */
+        int SafeRead(std::string& buf, int len, int seconds);
+
+        /**
+         * \brief Reads decrypted application data into a caller provided buffer.
+         *
+         * \param buf Pointer to the buffer where the received data will be stored.
+         * \param len The size of the buffer.
+         * \return Returns the number of bytes received, 0 if the peer closed the session, or a negative value indicating an error.
+         */
+        int Read(char* buf, size_t len);
+
+        /**
+         * \brief Reads decrypted application data into a caller provided buffer with a timeout.
+         *
+         * \param buf Pointer to the buffer where the received data will be stored.
+         * \param len The size of the buffer.
+         * \param seconds The timeout duration in seconds.
+         * \return Returns the number of bytes received, or a negative value on timeout or error.
+         */
+        int SafeRead(char* buf, size_t len, int seconds) override;
+
+        /**
+         * \brief Encrypts and writes raw bytes.
+         *
+         * \param buf Pointer to the data to write.
+         * \param len The number of bytes to write.
+         * \return Returns the number of bytes written on success, or a negative value indicating an error.
+         */
+        int Write(const char* buf, size_t len) override;
+
+        /**
+         * \brief Encrypts and writes application data.
+         *
+         * \param msg The data to write.
+         * \return Returns the number of bytes written on success, or a negative value indicating an error.
+         */
+        int Write(const std::string& msg);
+
+        /**
+         * \brief Sends a file region over the TLS session.
+         *
+         * With kTLS send offload the file is encrypted by the kernel through `sendfile`, without copying it
+         * through user space. Otherwise the region is read in chunks and encrypted by OpenSSL.
+         *
+         * \param fd The file descriptor to send from.
+         * \param offset The offset of the first byte to send.
+         * \param size The number of bytes to send.
+         * \return Returns the number of bytes sent, or a negative value indicating an error.
+         */
+        long SendFile(int fd, off_t offset, size_t size);
+
+        /**
+         * \brief Sends a TLS close_notify alert.
+         */
+        void Shutdown();
+
+        bool IsKtlsSend() const;
+        bool IsKtlsReceive() const;
+        bool IsSessionReused() const;
+
+    private:
+        SSL* m_Ssl;
+        Socket& m_Socket;
+    };
+
+} // namespace cppserv
+
+
+#endif // __TLSCONNECTION_H__
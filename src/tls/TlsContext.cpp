@@ -0,0 +1,76 @@
+#include "TlsContext.h"
+
+#include <openssl/err.h>
+
+#include "../logger/Logger.h"
+
+namespace cppserv {
+
+    static const unsigned char TLS_SESSION_ID_CONTEXT[] = "cppserv";
+
+    TlsContext::~TlsContext() {
+        if (m_Context != nullptr) {
+            SSL_CTX_free(m_Context);
+        }
+    }
+
+    int TlsContext::Init(const TlsConfig& config) {
+        m_Config = config;
+
+        m_Context = SSL_CTX_new(TLS_server_method());
+        if (m_Context == nullptr) {
+            LogErrors("tls context");
+            return -1;
+        }
+
+        SSL_CTX_set_min_proto_version(m_Context, TLS1_2_VERSION);
+        SSL_CTX_set_options(m_Context, SSL_OP_NO_COMPRESSION | SSL_OP_NO_RENEGOTIATION | SSL_OP_CIPHER_SERVER_PREFERENCE);
+        SSL_CTX_set_mode(m_Context, SSL_MODE_RELEASE_BUFFERS);
+
+        if (m_Config.enableKtls) {
+            SSL_CTX_set_options(m_Context, SSL_OP_ENABLE_KTLS);
+        }
+
+        // resumption: stateless tickets for TLS 1.3/1.2 clients that support them, session cache otherwise
+        SSL_CTX_set_session_id_context(m_Context, TLS_SESSION_ID_CONTEXT, sizeof(TLS_SESSION_ID_CONTEXT) - 1);
+        SSL_CTX_set_session_cache_mode(m_Context, SSL_SESS_CACHE_SERVER);
+        SSL_CTX_sess_set_cache_size(m_Context, m_Config.sessionCacheSize);
+        SSL_CTX_set_timeout(m_Context, m_Config.sessionTimeoutSeconds);
+        SSL_CTX_set_num_tickets(m_Context, m_Config.numTickets);
+
+        if (SSL_CTX_use_certificate_chain_file(m_Context, m_Config.certificateFile.c_str()) != 1) {
+            LogErrors("tls certificate");
+            return -1;
+        }
+        if (SSL_CTX_use_PrivateKey_file(m_Context, m_Config.privateKeyFile.c_str(), SSL_FILETYPE_PEM) != 1) {
+            LogErrors("tls private key");
+            return -1;
+        }
+        if (SSL_CTX_check_private_key(m_Context) != 1) {
+            LogErrors("tls key mismatch");
+            return -1;
+        }
+
+        CPPSERV_INFO("TLS enabled with certificate {} (kTLS {})", m_Config.certificateFile, m_Config.enableKtls ? "requested" : "off");
+        return 0;
+    }
+
+    long TlsContext::GetResumedSessions() const {
+        return m_Context != nullptr ? SSL_CTX_sess_hits(m_Context) : 0;
+    }
+
+    void TlsContext::LogErrors(const char* what) {
+        unsigned long code;
+        char message[256];
+        bool logged = false;
+        while ((code = ERR_get_error()) != 0) {
+            ERR_error_string_n(code, message, sizeof(message));
+            CPPSERV_ERROR("{} error: {}", what, message);
+            logged = true;
+        }
+        if (!logged) {
+            CPPSERV_ERROR("{} error: {}", what, strerror(errno));
+        }
+    }
+
+} // namespace cppserv
@@ -0,0 +1,68 @@
+#ifndef __TLSCONTEXT_H__
+#define __TLSCONTEXT_H__
+
+#include <string>
+
+#include <openssl/ssl.h>
+
+#include "../core/cppservcore.h"
+
+namespace cppserv {
+
+    struct TlsConfig {
+        std::string certificateFile;
+        std::string privateKeyFile;
+        bool enableKtls = true;
+        long sessionCacheSize = 20480;
+        long sessionTimeoutSeconds = 300;
+        size_t numTickets = 2;
+    };
+
+    class TlsContext {
+    public:
+        TlsContext() {}
+        ~TlsContext();
+
+        TlsContext(const TlsContext&) = delete;
+        TlsContext& operator=(const TlsContext&) = delete;
+
+        /**
+         * \brief Initializes the server side TLS context.
+         *
+         * This function loads the certificate chain and private key and configures TLS 1.2 and 1.3 with
+         * resumption through session tickets and a server side session cache. The cache belongs to the
+         * context and is therefore shared by all connections and worker threads. If `enableKtls` is set,
+         * OpenSSL is asked to hand the record layer to the kernel (`TCP_ULP` "tls") after the handshake;
+         * connections silently stay on user-space encryption when the kernel or cipher does not support it.
+         *
+         * \param config The TLS configuration.
+         * \return Returns 0 on success, or a negative value indicating an error.
+         */
+        int Init(const TlsConfig& config);
+
+        /**
+         * \brief Returns the native OpenSSL context.
+         */
+        SSL_CTX* GetNative() const { return m_Context; }
+
+        /**
+         * \brief Returns the number of handshakes that resumed a cached session or ticket.
+         */
+        long GetResumedSessions() const;
+
+        /**
+         * \brief Logs the last OpenSSL errors of the calling thread.
+         *
+         * \param what A short description of the failed operation.
+         */
+        static void LogErrors(const char* what);
+
+    private:
+        SSL_CTX* m_Context = nullptr;
+        TlsConfig m_Config;
+    };
+
+} // namespace cppserv
+
+
+#endif // __TLSCONTEXT_H__
@@ -0,0 +1,108 @@
+#include "LoopbackTransport.h"
+
+#include <thread>
+#include <cstring>
+#include <algorithm>
+
+#include "../metrics/TscClock.h"
+
+namespace cppserv {
+
+    static size_t RoundUpToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    LoopbackRing::LoopbackRing(size_t capacity) {
+        capacity = RoundUpToPowerOfTwo(std::max<size_t>(capacity, 64));
+        m_Data.reset(new char[capacity]);
+        m_Mask = capacity - 1;
+    }
+
+    size_t LoopbackRing::Write(const char* data, size_t len) {
+        uint64_t head = m_Head.load(std::memory_order_relaxed);
+        uint64_t tail = m_Tail.load(std::memory_order_acquire);
+        size_t count = std::min(len, (m_Mask + 1) - (size_t)(head - tail));
+        if (count == 0) {
+            return 0;
+        }
+        size_t offset = (size_t)head & m_Mask;
+        size_t first = std::min(count, (m_Mask + 1) - offset);
+        memcpy(m_Data.get() + offset, data, first);
+        memcpy(m_Data.get(), data + first, count - first);
+        m_Head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t LoopbackRing::Read(char* data, size_t len) {
+        uint64_t tail = m_Tail.load(std::memory_order_relaxed);
+        uint64_t head = m_Head.load(std::memory_order_acquire);
+        size_t count = std::min(len, (size_t)(head - tail));
+        if (count == 0) {
+            return 0;
+        }
+        size_t offset = (size_t)tail & m_Mask;
+        size_t first = std::min(count, (m_Mask + 1) - offset);
+        memcpy(data, m_Data.get() + offset, first);
+        memcpy(data + first, m_Data.get(), count - first);
+        m_Tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    void LoopbackRing::Reset() {
+        m_Head.store(0, std::memory_order_relaxed);
+        m_Tail.store(0, std::memory_order_relaxed);
+        m_Closed.store(false, std::memory_order_release);
+    }
+
+    int LoopbackTransport::SafeRead(char* buf, size_t len, int seconds) {
+        uint64_t deadline = 0;
+        for (;;) {
+            size_t count = m_In.Read(buf, len);
+            if (count > 0) {
+                return (int)count;
+            }
+            // the closed flag is set after the last write, check the ring once more before reporting the end
+            if (m_In.IsClosed()) {
+                count = m_In.Read(buf, len);
+                return (int)count;
+            }
+            uint64_t now = TscClock::MonotonicNanoseconds();
+            if (deadline == 0) {
+                deadline = now + (uint64_t)seconds * 1000000000ull;
+            }
+            if (now >= deadline) {
+                return -1;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    int LoopbackTransport::Write(const char* buf, size_t len) {
+        size_t written = 0;
+        uint64_t deadline = 0;
+        while (written < len) {
+            if (m_In.IsClosed() && m_Out.IsClosed()) {
+                break;
+            }
+            size_t count = m_Out.Write(buf + written, len - written);
+            written += count;
+            if (count > 0 || written == len) {
+                continue;
+            }
+            uint64_t now = TscClock::MonotonicNanoseconds();
+            if (deadline == 0) {
+                deadline = now + 10000000000ull;
+            }
+            if (now >= deadline) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+        return written > 0 ? (int)written : -1;
+    }
+
+} // namespace cppserv
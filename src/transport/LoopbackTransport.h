@@ -0,0 +1,129 @@
+#ifndef __LOOPBACKTRANSPORT_H__
+#define __LOOPBACKTRANSPORT_H__
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+#include "Transport.h"
+
+namespace cppserv {
+
+    /**
+     * \brief Default capacity of a loopback ring, large enough for a request or response to never wait.
+     */
+    constexpr size_t LOOPBACK_RING_SIZE = 256 * 1024;
+
+    /**
+     * \brief A single producer, single consumer byte ring.
+     *
+     * The producer only advances the head and the consumer only the tail, each with a release store
+     * the other side reads with acquire; no locks and no system calls.
+     */
+    class LoopbackRing {
+    public:
+        /**
+         * \param capacity The capacity in bytes, rounded up to a power of two.
+         */
+        explicit LoopbackRing(size_t capacity = LOOPBACK_RING_SIZE);
+
+        LoopbackRing(const LoopbackRing&) = delete;
+        LoopbackRing& operator=(const LoopbackRing&) = delete;
+
+        /**
+         * \brief Copies as much of the data as fits into the ring.
+         *
+         * \return Returns the number of bytes copied.
+         */
+        size_t Write(const char* data, size_t len);
+
+        /**
+         * \brief Copies up to len bytes out of the ring.
+         *
+         * \return Returns the number of bytes copied.
+         */
+        size_t Read(char* data, size_t len);
+
+        size_t GetAvailable() const {
+            return (size_t)(m_Head.load(std::memory_order_acquire) - m_Tail.load(std::memory_order_acquire));
+        }
+
+        /**
+         * \brief Marks the end of the stream, the reader gets 0 once the ring is drained.
+         */
+        void Close() { m_Closed.store(true, std::memory_order_release); }
+        bool IsClosed() const { return m_Closed.load(std::memory_order_acquire); }
+
+        /**
+         * \brief Empties and reopens the ring. Neither side may use it concurrently.
+         */
+        void Reset();
+
+    private:
+        std::unique_ptr<char[]> m_Data;
+        size_t m_Mask;
+        alignas(64) std::atomic<uint64_t> m_Head = 0;
+        alignas(64) std::atomic<uint64_t> m_Tail = 0;
+        std::atomic<bool> m_Closed = false;
+    };
+
+    /**
+     * \brief One end of an in-process connection: reads from one ring and writes into the other.
+     *
+     * Reads return immediately when data is buffered, so a single thread can drive both ends as long
+     * as it writes a complete message before the other end reads it. Across threads a read with a
+     * timeout waits for the peer by yielding.
+     */
+    class LoopbackTransport : public Transport {
+    public:
+        LoopbackTransport(LoopbackRing& in, LoopbackRing& out) : m_In(in), m_Out(out) {}
+
+        int SafeRead(char* buf, size_t len, int seconds) override;
+
+        /**
+         * \brief Writes all data, waiting up to 10 seconds for the peer to make room.
+         *
+         * \return Returns the number of bytes written, or a negative value if the peer closed its end or nothing could be written.
+         */
+        int Write(const char* buf, size_t len) override;
+
+        /**
+         * \brief Closes the sending direction, the peer reads 0 once it consumed everything.
+         */
+        void Close() { m_Out.Close(); }
+
+    private:
+        LoopbackRing& m_In;
+        LoopbackRing& m_Out;
+    };
+
+    /**
+     * \brief Two connected loopback transports, a socketpair without the kernel.
+     */
+    class LoopbackPair {
+    public:
+        explicit LoopbackPair(size_t capacity = LOOPBACK_RING_SIZE)
+            : m_ToServer(capacity), m_ToClient(capacity), m_Client(m_ToClient, m_ToServer), m_Server(m_ToServer, m_ToClient) {}
+
+        LoopbackTransport& GetClient() { return m_Client; }
+        LoopbackTransport& GetServer() { return m_Server; }
+
+        /**
+         * \brief Empties and reopens both directions, e.g. to reuse the pair for the next connection.
+         */
+        void Reset() {
+            m_ToServer.Reset();
+            m_ToClient.Reset();
+        }
+
+    private:
+        LoopbackRing m_ToServer;
+        LoopbackRing m_ToClient;
+        LoopbackTransport m_Client;
+        LoopbackTransport m_Server;
+    };
+
+} // namespace cppserv
+
+
+#endif // __LOOPBACKTRANSPORT_H__
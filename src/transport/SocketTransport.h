@@ -0,0 +1,83 @@
+#ifndef __SOCKETTRANSPORT_H__
+#define __SOCKETTRANSPORT_H__
+
+#include <ctime>
+#include <cerrno>
+#include <cstdint>
+
+#include "Transport.h"
+#include "../socket/Socket.h"
+
+namespace cppserv {
+
+    /**
+     * \brief A Transport over a connected, blocking socket.
+     */
+    class SocketTransport : public Transport {
+    public:
+        /**
+         * \param socket The connected socket.
+         * \param receiveTimestamps Reads the kernel receive timestamp of the first read, the socket must
+         *        have them enabled, see `Socket::EnableReceiveTimestamps`.
+         */
+        explicit SocketTransport(Socket& socket, bool receiveTimestamps = false)
+            : m_Socket(socket), m_ReceiveTimestamps(receiveTimestamps) {}
+
+        int SafeRead(char* buf, size_t len, int seconds) override {
+            if (!m_ReceiveTimestamps) {
+                return m_Socket.SocketSafeRead(buf, len, seconds);
+            }
+            uint64_t kernelNs = 0;
+            int received = m_Socket.SocketSafeReadTimestamped(buf, len, seconds, kernelNs);
+            if (received > 0) {
+                m_ReceiveTimestamps = false;
+                if (kernelNs != 0) {
+                    struct timespec now;
+                    clock_gettime(CLOCK_REALTIME, &now);
+                    uint64_t nowNs = (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+                    m_ReceiveQueueNs = nowNs > kernelNs ? nowNs - kernelNs : 0;
+                    m_HasReceiveQueue = true;
+                }
+            }
+            return received;
+        }
+
+        /**
+         * \brief Writes all of `buf`; a blocking send returns short when a signal interrupts it.
+         */
+        int Write(const char* buf, size_t len) override {
+            size_t written = 0;
+            while (written < len) {
+                int count = m_Socket.SocketWrite(buf + written, len - written);
+                if (count < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (count <= 0) {
+                    return written > 0 ? (int)written : count;
+                }
+                written += (size_t)count;
+            }
+            return (int)written;
+        }
+
+        /**
+         * \brief Returns true if the first read delivered a kernel receive timestamp.
+         */
+        bool HasReceiveQueue() const { return m_HasReceiveQueue; }
+
+        /**
+         * \brief Returns the nanoseconds the bytes of the first read waited in the kernel before the read returned.
+         */
+        uint64_t GetReceiveQueueNs() const { return m_ReceiveQueueNs; }
+
+    private:
+        Socket& m_Socket;
+        bool m_ReceiveTimestamps;
+        bool m_HasReceiveQueue = false;
+        uint64_t m_ReceiveQueueNs = 0;
+    };
+
+} // namespace cppserv
+
+
+#endif // __SOCKETTRANSPORT_H__
@@ -0,0 +1,41 @@
+#ifndef __TRANSPORT_H__
+#define __TRANSPORT_H__
+
+#include <cstddef>
+
+namespace cppserv {
+
+    /**
+     * \brief A byte stream the request pipeline reads requests from and writes responses to.
+     *
+     * Implemented by SocketTransport for plain TCP, TlsConnection for TLS and LoopbackTransport for
+     * kernel-free in-process connections used by benchmarks.
+     */
+    class Transport {
+    public:
+        virtual ~Transport() {}
+
+        /**
+         * \brief Waits for data and reads what is available.
+         *
+         * \param buf Pointer to the buffer where the received data will be stored.
+         * \param len The size of the buffer.
+         * \param seconds The timeout duration in seconds.
+         * \return Returns the number of bytes received, 0 if the peer closed the stream, or a negative value on timeout or error.
+         */
+        virtual int SafeRead(char* buf, size_t len, int seconds) = 0;
+
+        /**
+         * \brief Writes data.
+         *
+         * \param buf Pointer to the data to write.
+         * \param len The number of bytes to write.
+         * \return Returns the number of bytes written on success, or a negative value indicating an error.
+         */
+        virtual int Write(const char* buf, size_t len) = 0;
+    };
+
+} // namespace cppserv
+
+
+#endif // __TRANSPORT_H__
@@ -0,0 +1,985 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <csignal>
+#include <sched.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/wait.h>
+
+#include "../../src/socket/Socket.h"
+#include "../../src/logger/Logger.h"
+#include "../../src/metrics/Metrics.h"
+#include "../../src/metrics/TscClock.h"
+#include "../../src/capture/CaptureFormat.h"
+
+/**
+ * @brief cppserv-loadgen drives a constant request rate against a server and reports its latency.
+ *
+ * The generator is open-loop: every request has an intended start time on a fixed schedule that does
+ * not depend on how fast the server answers. When all connections of a thread are busy the due
+ * requests queue up and their latency is measured from the intended start, not from when they were
+ * finally sent. This corrects for coordinated omission, a stalled server shows up in the tail instead
+ * of silently lowering the offered load. The service time (send to last byte) is reported as well.
+ *
+ * With `--replay` it sends requests captured by `cppserv --capture` with their original timing, scaled
+ * or as fast as possible, over one connection per captured connection slot.
+ *
+ * With `--sweep` it starts the server itself once per worker count and reports how throughput, latency
+ * and CPU per request change with the number of cores.
+ */
+
+struct LoadOptions {
+    std::string host = "127.0.0.1";
+    std::string port = "8080";
+    std::string path = "/";
+    double rate = 1000;
+    double duration = 10;
+    size_t threads = 1;
+    size_t connections = 16;
+    double timeout = 5;
+    bool close = false;
+    bool json = false;
+    std::string sweep;
+    size_t sweepMax = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    std::string csv = "sweep.csv";
+    std::string replay;
+    double speed = 1;
+};
+
+/**
+ * @brief Totals shared by all threads.
+ */
+struct LoadResults {
+    std::atomic<uint64_t> sent = 0;
+    std::atomic<uint64_t> completed = 0;
+    std::atomic<uint64_t> errors = 0;
+    std::atomic<uint64_t> timeouts = 0;
+    std::atomic<uint64_t> unsent = 0;
+    std::atomic<uint64_t> connects = 0;
+    std::atomic<uint64_t> statusClasses[6] = {};
+    std::atomic<uint64_t> maxLatency = 0;
+    std::atomic<uint64_t> maxServiceTime = 0;
+    cppserv::Histogram latency;
+    cppserv::Histogram serviceTime;
+};
+
+/**
+ * @brief A captured request and when it arrived, relative to the first request of the capture.
+ */
+struct ReplayRequest {
+    uint64_t offsetNs;
+    std::string data;
+};
+
+/**
+ * @brief A keep-alive client connection and the request in flight on it.
+ */
+struct ClientConnection {
+    cppserv::Socket socket;
+    bool connected = false;
+    bool busy = false;
+    bool retried = false;
+    uint64_t intended = 0;
+    uint64_t sent = 0;
+    std::string response;
+    const std::string* request = nullptr;
+    std::vector<ReplayRequest> script;
+    size_t scriptNext = 0;
+};
+
+
+/**
+ * @brief Prints the usage of the program and exits with status code EXIT_FAILURE.
+ *
+ * @param program the name of the program
+ */
+void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+        << "  --host <ip>            server address (default 127.0.0.1)\n"
+        << "  --port <port>          server port (default 8080)\n"
+        << "  --path <path>          request path (default /)\n"
+        << "  --rate <n>             total requests per second, 0 for closed-loop (default 1000)\n"
+        << "  --duration <seconds>   length of the run (default 10)\n"
+        << "  --threads <n>          client threads (default 1)\n"
+        << "  --connections <n>      keep-alive connections over all threads (default 16)\n"
+        << "  --timeout <seconds>    response timeout (default 5)\n"
+        << "  --close                ask the server to close the connection after every response\n"
+        << "  --sweep <server>       start the server binary with 1 to --sweep-max pinned workers and\n"
+        << "                         measure a fixed workload mix closed-loop for each worker count\n"
+        << "  --sweep-max <n>        largest worker count of the sweep (default: cores)\n"
+        << "  --csv <file>           CSV output of the sweep (default sweep.csv)\n"
+        << "  --replay <file>        replay a capture recorded with cppserv --capture, over one\n"
+        << "                         connection per captured connection slot\n"
+        << "  --speed <factor>       replay speed, 1 is the original timing, 0 as fast as possible (default 1)\n"
+        << "  --format text|json     report format (default text)\n";
+    exit(EXIT_FAILURE);
+}
+
+
+/**
+ * @brief Raises an atomic maximum.
+ */
+void update_max(std::atomic<uint64_t>& max, uint64_t value) {
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+
+/**
+ * @brief Returns the value of a header in a raw response head, matching the name case-insensitively.
+ *
+ * @param head the status line and headers
+ * @param name the lower case header name
+ * @return the trimmed value, empty if the header is missing
+ */
+std::string_view find_header(std::string_view head, std::string_view name) {
+    size_t pos = head.find("\r\n");
+    while (pos != std::string_view::npos && pos + 2 < head.size()) {
+        size_t start = pos + 2;
+        size_t end = head.find("\r\n", start);
+        std::string_view line = head.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+        if (line.size() > name.size() && line[name.size()] == ':') {
+            bool match = true;
+            for (size_t i = 0; i < name.size(); i++) {
+                if (tolower((unsigned char)line[i]) != name[i]) {
+                    match = false;
+                    break;
+                }
+            }
+            if (match) {
+                std::string_view value = line.substr(name.size() + 1);
+                while (!value.empty() && value.front() == ' ') {
+                    value.remove_prefix(1);
+                }
+                return value;
+            }
+        }
+        pos = end;
+    }
+    return {};
+}
+
+
+/**
+ * @brief Checks whether a buffered response is complete.
+ *
+ * Responses without a Content-Length are complete when the server closes the connection.
+ *
+ * @param response the bytes received so far
+ * @param status set to the response status once the head is complete
+ * @param keepAlive set to false if the server announced that it closes the connection
+ * @return true if the whole response has been received
+ */
+bool response_complete(const std::string& response, int& status, bool& keepAlive) {
+    size_t headEnd = response.find("\r\n\r\n");
+    if (headEnd == std::string::npos) {
+        return false;
+    }
+    std::string_view head(response.data(), headEnd);
+    size_t space = head.find(' ');
+    status = space != std::string_view::npos ? atoi(head.data() + space + 1) : 0;
+
+    std::string_view connection = find_header(head, "connection");
+    keepAlive = !(connection.size() == 5 && strncasecmp(connection.data(), "close", 5) == 0);
+
+    std::string_view length = find_header(head, "content-length");
+    if (length.empty()) {
+        return false;
+    }
+    return response.size() >= headEnd + 4 + strtoull(std::string(length).c_str(), nullptr, 10);
+}
+
+
+/**
+ * @brief Drives the share of one thread: its connections and its slice of the request rate.
+ */
+class LoadWorker {
+public:
+    LoadWorker(const LoadOptions& options, LoadResults& results, size_t connections, uint64_t start, uint64_t interval)
+        : m_Options(options), m_Results(results), m_Connections(connections), m_Start(start), m_Interval(interval) {
+        m_Request = "GET " + options.path + " HTTP/1.1\r\nHost: " + options.host + "\r\n"
+            + (options.close ? "Connection: close\r\n\r\n" : "\r\n");
+    }
+
+    /**
+     * @brief Creates a worker that replays captured requests, one script per connection.
+     */
+    LoadWorker(const LoadOptions& options, LoadResults& results, std::vector<std::vector<ReplayRequest>> scripts, uint64_t start)
+        : m_Options(options), m_Results(results), m_Connections(scripts.size()), m_Start(start), m_Interval(0) {
+        for (size_t i = 0; i < scripts.size(); i++) {
+            m_Connections[i].script = std::move(scripts[i]);
+        }
+    }
+
+    void Run() {
+        m_Epoll = epoll_create1(0);
+        if (m_Epoll < 0) {
+            CPPSERV_ERROR("epoll_create1 error: {}", strerror(errno));
+            return;
+        }
+
+        uint64_t end = m_Start + (uint64_t)(m_Options.duration * 1e9);
+        uint64_t timeout = (uint64_t)(m_Options.timeout * 1e9);
+        uint64_t next = m_Start;
+        std::deque<uint64_t> due;
+        epoll_event events[64];
+
+        for (;;) {
+            uint64_t now = cppserv::TscClock::MonotonicNanoseconds();
+
+            if (m_Interval == 0) {
+                // closed-loop: every idle connection sends its next request right away
+                for (size_t i = 0; i < m_Connections.size() && now < end; i++) {
+                    if (!m_Connections[i].busy) {
+                        Send(i, now, &m_Request);
+                    }
+                }
+            }
+
+            // the schedule only depends on the clock, never on the responses
+            while (m_Interval > 0 && next <= now && next < end) {
+                due.push_back(next);
+                next += m_Interval;
+            }
+
+            for (size_t i = 0; i < m_Connections.size() && !due.empty(); i++) {
+                if (!m_Connections[i].busy) {
+                    Send(i, due.front(), &m_Request);
+                    due.pop_front();
+                }
+            }
+
+            size_t busy = 0;
+            for (size_t i = 0; i < m_Connections.size(); i++) {
+                ClientConnection& connection = m_Connections[i];
+                if (connection.busy && now > connection.sent + timeout) {
+                    connection.busy = false;
+                    m_Results.timeouts.fetch_add(1, std::memory_order_relaxed);
+                    Disconnect(i);
+                }
+                busy += connection.busy;
+            }
+
+            if (now >= end && busy == 0 && due.empty()) {
+                break;
+            }
+            if (now >= end + timeout) {
+                // requests that never found a free connection
+                m_Results.unsent.fetch_add(due.size(), std::memory_order_relaxed);
+                break;
+            }
+
+            int wait = 1;
+            if (m_Interval > 0 && due.empty() && next < end) {
+                wait = (int)std::clamp<uint64_t>((next - now) / 1000000, 0, 100);
+            }
+            int count = epoll_wait(m_Epoll, events, 64, wait);
+            for (int i = 0; i < count; i++) {
+                Receive(events[i].data.u32);
+            }
+        }
+
+        for (size_t i = 0; i < m_Connections.size(); i++) {
+            Disconnect(i);
+        }
+        close(m_Epoll);
+    }
+
+    /**
+     * @brief Sends the script of every connection in order, each request at its captured offset
+     * divided by the speed, or as soon as the connection is idle with speed 0.
+     *
+     * A request whose connection is still busy at its intended time is sent late, its latency
+     * still counts from the intended time.
+     */
+    void RunReplay() {
+        m_Epoll = epoll_create1(0);
+        if (m_Epoll < 0) {
+            CPPSERV_ERROR("epoll_create1 error: {}", strerror(errno));
+            return;
+        }
+
+        uint64_t timeout = (uint64_t)(m_Options.timeout * 1e9);
+        epoll_event events[64];
+
+        for (;;) {
+            uint64_t now = cppserv::TscClock::MonotonicNanoseconds();
+            uint64_t nextDue = UINT64_MAX;
+            bool remaining = false;
+            size_t busy = 0;
+
+            for (size_t i = 0; i < m_Connections.size(); i++) {
+                ClientConnection& connection = m_Connections[i];
+                if (connection.busy && now > connection.sent + timeout) {
+                    connection.busy = false;
+                    m_Results.timeouts.fetch_add(1, std::memory_order_relaxed);
+                    Disconnect(i);
+                }
+                if (!connection.busy && connection.scriptNext < connection.script.size()) {
+                    const ReplayRequest& request = connection.script[connection.scriptNext];
+                    uint64_t intended = m_Start + (m_Options.speed > 0 ? (uint64_t)((double)request.offsetNs / m_Options.speed) : 0);
+                    if (m_Options.speed == 0 && now >= m_Start) {
+                        intended = now;
+                    }
+                    if (intended <= now) {
+                        connection.scriptNext++;
+                        Send(i, intended, &request.data);
+                    } else {
+                        nextDue = std::min(nextDue, intended);
+                    }
+                }
+                remaining |= connection.scriptNext < connection.script.size();
+                busy += connection.busy;
+            }
+
+            if (!remaining && busy == 0) {
+                break;
+            }
+
+            int wait = 100;
+            if (nextDue != UINT64_MAX) {
+                wait = (int)std::clamp<uint64_t>((nextDue - now) / 1000000, 0, 100);
+            }
+            int count = epoll_wait(m_Epoll, events, 64, wait);
+            for (int i = 0; i < count; i++) {
+                Receive(events[i].data.u32);
+            }
+        }
+
+        for (size_t i = 0; i < m_Connections.size(); i++) {
+            Disconnect(i);
+        }
+        close(m_Epoll);
+    }
+
+private:
+    bool Connect(size_t index) {
+        ClientConnection& connection = m_Connections[index];
+        connection.socket = cppserv::Socket(AF_INET, SOCK_STREAM, 0);
+        if (connection.socket.Connect(m_Options.host, m_Options.port) != 0) {
+            connection.socket.Close();
+            return false;
+        }
+        connection.socket.SetNonBlocking();
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.u32 = (uint32_t)index;
+        if (epoll_ctl(m_Epoll, EPOLL_CTL_ADD, connection.socket.GetHandle(), &event) < 0) {
+            CPPSERV_ERROR("epoll_ctl error: {}", strerror(errno));
+            connection.socket.Close();
+            return false;
+        }
+        connection.connected = true;
+        m_Results.connects.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void Disconnect(size_t index) {
+        ClientConnection& connection = m_Connections[index];
+        if (connection.connected) {
+            epoll_ctl(m_Epoll, EPOLL_CTL_DEL, connection.socket.GetHandle(), nullptr);
+            connection.socket.Close();
+            connection.connected = false;
+        }
+        if (connection.busy) {
+            connection.busy = false;
+            m_Results.errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        connection.response.clear();
+    }
+
+    /**
+     * @brief Sends a request, reconnecting first if the connection was closed.
+     *
+     * @param index the connection
+     * @param intended the time the request should have been sent at
+     */
+    void Send(size_t index, uint64_t intended, const std::string* request) {
+        ClientConnection& connection = m_Connections[index];
+        connection.request = request;
+        connection.intended = intended;
+        connection.retried = false;
+        m_Results.sent.fetch_add(1, std::memory_order_relaxed);
+        Write(index);
+    }
+
+    void Write(size_t index) {
+        ClientConnection& connection = m_Connections[index];
+        connection.busy = true;
+        connection.response.clear();
+        if (!connection.connected && !Connect(index)) {
+            connection.busy = false;
+            m_Results.errors.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        connection.sent = cppserv::TscClock::MonotonicNanoseconds();
+        if (!SendAll(connection.socket.GetHandle(), *connection.request)) {
+            Retry(index);
+        }
+    }
+
+    /**
+     * @brief Writes a whole request, waiting for the send buffer if a large captured request does not fit.
+     */
+    bool SendAll(int handle, const std::string& request) {
+        size_t written = 0;
+        while (written < request.size()) {
+            ssize_t count = send(handle, request.data() + written, request.size() - written, MSG_NOSIGNAL);
+            if (count > 0) {
+                written += (size_t)count;
+                continue;
+            }
+            if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                struct pollfd writable = { handle, POLLOUT, 0 };
+                if (poll(&writable, 1, (int)(m_Options.timeout * 1000)) > 0) {
+                    continue;
+                }
+            }
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Resends a request on a new connection if the old one was closed before the server answered.
+     *
+     * A server that closes idle keep-alive connections races with the next request; the request is
+     * retried once, and its latency still counts from the intended start.
+     */
+    void Retry(size_t index) {
+        ClientConnection& connection = m_Connections[index];
+        bool retry = connection.busy && connection.response.empty() && !connection.retried;
+        connection.busy = !retry && connection.busy;
+        Disconnect(index);
+        if (retry) {
+            connection.retried = true;
+            Write(index);
+        }
+    }
+
+    void Receive(uint32_t index) {
+        ClientConnection& connection = m_Connections[index];
+        if (!connection.connected) {
+            return;
+        }
+
+        bool closed = false;
+        char buffer[16384];
+        for (;;) {
+            ssize_t count = recv(connection.socket.GetHandle(), buffer, sizeof(buffer), 0);
+            if (count > 0) {
+                connection.response.append(buffer, (size_t)count);
+                continue;
+            }
+            if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            closed = true;
+            break;
+        }
+
+        int status = 0;
+        bool keepAlive = true;
+        if (connection.busy && !connection.response.empty()
+            && (response_complete(connection.response, status, keepAlive) || (closed && status != 0))) {
+            Complete(connection, status);
+            if (!keepAlive) {
+                closed = true;
+            }
+        }
+
+        if (closed) {
+            Retry(index);
+        }
+    }
+
+    void Complete(ClientConnection& connection, int status) {
+        uint64_t now = cppserv::TscClock::MonotonicNanoseconds();
+        uint64_t latency = now - std::min(connection.intended, connection.sent);
+        uint64_t serviceTime = now - connection.sent;
+
+        m_Results.latency.Record(latency);
+        m_Results.serviceTime.Record(serviceTime);
+        update_max(m_Results.maxLatency, latency);
+        update_max(m_Results.maxServiceTime, serviceTime);
+        m_Results.completed.fetch_add(1, std::memory_order_relaxed);
+        m_Results.statusClasses[status >= 100 && status < 600 ? status / 100 : 0].fetch_add(1, std::memory_order_relaxed);
+
+        connection.busy = false;
+        connection.response.clear();
+    }
+
+private:
+    const LoadOptions& m_Options;
+    LoadResults& m_Results;
+    std::vector<ClientConnection> m_Connections;
+    uint64_t m_Start;
+    uint64_t m_Interval;
+    std::string m_Request;
+    int m_Epoll = -1;
+
+};
+
+
+/**
+ * @brief Formats nanoseconds as milliseconds.
+ */
+std::string format_ms(uint64_t ns) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.3f", (double)ns / 1e6);
+    return text;
+}
+
+
+const double s_Percentiles[] = { 0.5, 0.9, 0.99, 0.999, 0.9999 };
+const char* s_PercentileNames[] = { "p50", "p90", "p99", "p99.9", "p99.99" };
+
+
+void print_text(const std::string& title, const cppserv::HistogramSnapshot& snapshot, uint64_t max) {
+    std::cout << title << " (ms):\n";
+    for (size_t i = 0; i < sizeof(s_Percentiles) / sizeof(s_Percentiles[0]); i++) {
+        std::cout << "  " << s_PercentileNames[i] << "\t" << format_ms(std::min(snapshot.Percentile(s_Percentiles[i]), max)) << "\n";
+    }
+    std::cout << "  max\t" << format_ms(max) << "\n";
+    std::cout << "  mean\t" << format_ms(snapshot.count > 0 ? snapshot.sum / snapshot.count : 0) << "\n";
+}
+
+
+void print_json(const cppserv::HistogramSnapshot& snapshot, uint64_t max) {
+    std::cout << "{";
+    for (size_t i = 0; i < sizeof(s_Percentiles) / sizeof(s_Percentiles[0]); i++) {
+        std::cout << "\"" << s_PercentileNames[i] << "\":" << std::min(snapshot.Percentile(s_Percentiles[i]), max) << ",";
+    }
+    std::cout << "\"max\":" << max << ",\"mean\":" << (snapshot.count > 0 ? snapshot.sum / snapshot.count : 0) << "}";
+}
+
+
+/**
+ * @brief Runs the workers of one load run.
+ *
+ * @param options the load to generate
+ * @param results receives the results
+ * @return the duration of the run in seconds
+ */
+double run_load(const LoadOptions& options, LoadResults& results) {
+    // every thread sends every threads-th request of the global schedule, offset by its index
+    uint64_t interval = options.rate > 0 ? (uint64_t)(1e9 * (double)options.threads / options.rate) : 0;
+    uint64_t start = cppserv::TscClock::MonotonicNanoseconds() + 100000000;
+
+    std::vector<std::unique_ptr<LoadWorker>> workers;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < options.threads; i++) {
+        size_t connections = options.connections / options.threads + (i < options.connections % options.threads);
+        workers.push_back(std::make_unique<LoadWorker>(options, results, connections, start + interval * i / options.threads, interval));
+    }
+    for (auto& worker : workers) {
+        threads.emplace_back([&worker] { worker->Run(); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return (double)(cppserv::TscClock::MonotonicNanoseconds() - start) / 1e9;
+}
+
+
+/**
+ * @brief Reads a capture and splits it into one script per connection slot, ordered by arrival.
+ *
+ * @param path the capture file
+ * @param scripts receives the scripts
+ * @return the number of requests, or a negative value if the file is not a capture
+ */
+int64_t load_capture(const std::string& path, std::vector<std::vector<ReplayRequest>>& scripts) {
+    std::ifstream file(path, std::ios::binary);
+    cppserv::CaptureFileHeader header;
+    if (!file.read((char*)&header, sizeof(header)) || memcmp(header.magic, cppserv::CAPTURE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != cppserv::CAPTURE_VERSION) {
+        CPPSERV_ERROR("{} is not a capture", path);
+        return -1;
+    }
+
+    struct Captured {
+        uint64_t arrivalNs;
+        uint32_t slot;
+        std::string data;
+    };
+    std::vector<Captured> requests;
+    cppserv::CaptureRecord record;
+    while (file.read((char*)&record, sizeof(record))) {
+        Captured captured{ record.arrivalNs, record.slot, std::string(record.length, '\0') };
+        char padding[8];
+        if (!file.read(captured.data.data(), record.length) || !file.read(padding, cppserv::CapturePad(record.length) - record.length)) {
+            CPPSERV_WARN("{}: truncated record, replaying the {} requests before it", path, requests.size());
+            break;
+        }
+        requests.push_back(std::move(captured));
+    }
+    if (requests.empty()) {
+        return 0;
+    }
+
+    // workers append concurrently, the file is only roughly in arrival order
+    std::stable_sort(requests.begin(), requests.end(), [](const Captured& a, const Captured& b) { return a.arrivalNs < b.arrivalNs; });
+    uint64_t first = requests.front().arrivalNs;
+    std::map<uint32_t, size_t> slots;
+    for (Captured& captured : requests) {
+        auto [it, inserted] = slots.emplace(captured.slot, scripts.size());
+        if (inserted) {
+            scripts.emplace_back();
+        }
+        scripts[it->second].push_back({ captured.arrivalNs - first, std::move(captured.data) });
+    }
+    return (int64_t)requests.size();
+}
+
+
+/**
+ * @brief Replays a capture, the connection slots are spread over the threads.
+ *
+ * @param options the replay options
+ * @param results receives the results
+ * @return the duration of the replay in seconds, or a negative value if the capture could not be read
+ */
+double run_replay(const LoadOptions& options, LoadResults& results) {
+    std::vector<std::vector<ReplayRequest>> scripts;
+    if (load_capture(options.replay, scripts) < 0) {
+        return -1;
+    }
+    uint64_t start = cppserv::TscClock::MonotonicNanoseconds() + 100000000;
+
+    std::vector<std::unique_ptr<LoadWorker>> workers;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < options.threads; i++) {
+        std::vector<std::vector<ReplayRequest>> assigned;
+        for (size_t slot = i; slot < scripts.size(); slot += options.threads) {
+            assigned.push_back(std::move(scripts[slot]));
+        }
+        workers.push_back(std::make_unique<LoadWorker>(options, results, std::move(assigned), start));
+    }
+    for (auto& worker : workers) {
+        threads.emplace_back([&worker] { worker->RunReplay(); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return (double)(cppserv::TscClock::MonotonicNanoseconds() - start) / 1e9;
+}
+
+
+/**
+ * @brief Prints the results of a load run.
+ *
+ * @param options the generated load
+ * @param results the results
+ * @param elapsed the duration of the run in seconds
+ */
+void report(const LoadOptions& options, const LoadResults& results, double elapsed) {
+    cppserv::HistogramSnapshot latency = results.latency.Snapshot();
+    cppserv::HistogramSnapshot serviceTime = results.serviceTime.Snapshot();
+    uint64_t completed = results.completed.load();
+    uint64_t errors = results.errors.load() + results.timeouts.load() + results.unsent.load();
+    double throughput = (double)completed / std::max(elapsed, options.duration);
+
+    if (options.json) {
+        std::cout << "{\"target\":\"" << options.host << ":" << options.port << options.path << "\"";
+        if (!options.replay.empty()) {
+            std::cout << ",\"replay\":\"" << options.replay << "\",\"speed\":" << options.speed;
+        }
+        std::cout << ",\"rate\":" << options.rate << ",\"duration\":" << options.duration
+            << ",\"threads\":" << options.threads << ",\"connections\":" << options.connections
+            << ",\"sent\":" << results.sent.load() << ",\"completed\":" << completed
+            << ",\"errors\":" << results.errors.load() << ",\"timeouts\":" << results.timeouts.load()
+            << ",\"unsent\":" << results.unsent.load() << ",\"connects\":" << results.connects.load()
+            << ",\"status\":{";
+        for (size_t i = 1; i < 6; i++) {
+            std::cout << "\"" << i << "xx\":" << results.statusClasses[i].load() << (i < 5 ? "," : "");
+        }
+        std::cout << "},\"throughput\":" << throughput << ",\"latency_ns\":";
+        print_json(latency, results.maxLatency.load());
+        std::cout << ",\"service_time_ns\":";
+        print_json(serviceTime, results.maxServiceTime.load());
+        std::cout << "}\n";
+    } else {
+        std::cout << "Target " << options.host << ":" << options.port << options.path << ", ";
+        if (!options.replay.empty()) {
+            std::cout << "replay of " << options.replay << " at speed " << options.speed << "\n";
+        } else if (options.rate > 0) {
+            std::cout << options.rate << " req/s";
+        } else {
+            std::cout << "closed-loop";
+        }
+        if (options.replay.empty()) {
+            std::cout << " for " << options.duration << "s over " << options.connections << " connections, "
+                << options.threads << " threads\n";
+        }
+        print_text("Latency, corrected for coordinated omission", latency, results.maxLatency.load());
+        print_text("Service time, uncorrected", serviceTime, results.maxServiceTime.load());
+        std::cout << "Requests: " << results.sent.load() << " sent, " << completed << " completed, "
+            << errors << " failed (" << results.timeouts.load() << " timeouts, " << results.unsent.load()
+            << " never sent), " << results.connects.load() << " connects\n";
+        std::cout << "Status: 2xx " << results.statusClasses[2].load() << ", 3xx " << results.statusClasses[3].load()
+            << ", 4xx " << results.statusClasses[4].load() << ", 5xx " << results.statusClasses[5].load() << "\n";
+        std::cout << "Throughput: " << throughput << " req/s\n";
+    }
+}
+
+
+/**
+ * @brief A request mix of the core-scaling sweep.
+ */
+struct SweepWorkload {
+    const char* name;
+    const char* path;
+    bool close;
+};
+
+static const SweepWorkload s_SweepWorkloads[] = {
+    { "tiny-keepalive", "/", false },
+    { "tiny-close", "/", true },
+    { "64k-keepalive", "/payload", false },
+    { "64k-close", "/payload", true },
+};
+
+
+/**
+ * @brief Starts the server binary with n pinned worker threads and waits until it accepts connections.
+ *
+ * @param options the options with the server binary and port
+ * @param threads the number of worker threads
+ * @return the pid of the server, or -1 on failure
+ */
+pid_t start_server(const LoadOptions& options, size_t threads) {
+    std::string threadCount = std::to_string(threads);
+    pid_t pid = fork();
+    if (pid < 0) {
+        CPPSERV_ERROR("fork error: {}", strerror(errno));
+        return -1;
+    }
+    if (pid == 0) {
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(devNull, STDOUT_FILENO);
+        dup2(devNull, STDERR_FILENO);
+        execl(options.sweep.c_str(), options.sweep.c_str(), "--port", options.port.c_str(), "--threads", threadCount.c_str(),
+            "--pin", "--payload-kb", "64", (char*)nullptr);
+        _exit(127);
+    }
+
+    for (int attempt = 0; attempt < 100; attempt++) {
+        usleep(50000);
+        int status;
+        if (waitpid(pid, &status, WNOHANG) == pid) {
+            CPPSERV_ERROR("{} exited with status {}", options.sweep, status);
+            return -1;
+        }
+        int probe = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons((uint16_t)atoi(options.port.c_str()));
+        inet_pton(AF_INET, options.host.c_str(), &address.sin_addr);
+        bool up = connect(probe, (struct sockaddr*)&address, sizeof(address)) == 0;
+        close(probe);
+        if (up) {
+            return pid;
+        }
+    }
+    CPPSERV_ERROR("{} did not start listening", options.sweep);
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    return -1;
+}
+
+
+/**
+ * @brief Returns the user and system CPU time a process used so far, in microseconds.
+ */
+uint64_t process_cpu_us(pid_t pid) {
+    std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+    std::string content((std::istreambuf_iterator<char>(stat)), std::istreambuf_iterator<char>());
+    // the command name may contain spaces, the fields are counted after its closing parenthesis
+    size_t end = content.rfind(')');
+    if (end == std::string::npos) {
+        return 0;
+    }
+    std::istringstream fields(content.substr(end + 2));
+    std::string field;
+    uint64_t utime = 0;
+    uint64_t stime = 0;
+    // utime and stime are fields 14 and 15, the 12th and 13th after the command name
+    for (int i = 3; i <= 15 && fields >> field; i++) {
+        if (i == 14) {
+            utime = strtoull(field.c_str(), nullptr, 10);
+        } else if (i == 15) {
+            stime = strtoull(field.c_str(), nullptr, 10);
+        }
+    }
+    return (utime + stime) * 1000000 / (uint64_t)sysconf(_SC_CLK_TCK);
+}
+
+
+/**
+ * @brief Keeps the load generator off the CPUs the server workers are pinned to, if there are CPUs left.
+ *
+ * @param serverThreads the number of pinned server workers, they occupy CPUs 0 to serverThreads - 1
+ */
+void pin_load_generator(size_t serverThreads) {
+    size_t cpus = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t cpu = serverThreads < cpus ? serverThreads : 0; cpu < cpus; cpu++) {
+        CPU_SET(cpu, &set);
+    }
+    // threads started afterwards inherit the mask
+    sched_setaffinity(0, sizeof(set), &set);
+}
+
+
+/**
+ * @brief Measures every workload against the server with 1 to sweepMax pinned worker threads.
+ *
+ * The load is closed-loop, every connection sends its next request as soon as the last one was answered,
+ * so the throughput is what the server sustains. The results are printed as a table and written as CSV.
+ *
+ * @param options the sweep options
+ * @return EXIT_SUCCESS, or EXIT_FAILURE if the server could not be started
+ */
+int run_sweep(LoadOptions options) {
+    std::ofstream csv(options.csv);
+    if (!csv) {
+        CPPSERV_ERROR("cannot write {}: {}", options.csv, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    csv << "threads,workload,throughput,p50_ns,p99_ns,cpu_us_per_request,completed,errors,connects\n";
+    printf("%-8s %-16s %12s %10s %10s %14s %10s\n", "threads", "workload", "req/s", "p50 ms", "p99 ms", "cpu us/req", "errors");
+
+    options.rate = 0;
+    for (size_t threads = 1; threads <= options.sweepMax; threads++) {
+        pid_t server = start_server(options, threads);
+        if (server < 0) {
+            return EXIT_FAILURE;
+        }
+        pin_load_generator(threads);
+
+        for (const SweepWorkload& workload : s_SweepWorkloads) {
+            options.path = workload.path;
+            options.close = workload.close;
+
+            LoadResults results;
+            uint64_t cpuBefore = process_cpu_us(server);
+            double elapsed = run_load(options, results);
+            uint64_t cpu = process_cpu_us(server) - cpuBefore;
+
+            cppserv::HistogramSnapshot latency = results.latency.Snapshot();
+            uint64_t completed = results.completed.load();
+            uint64_t errors = results.errors.load() + results.timeouts.load() + results.unsent.load();
+            double throughput = (double)completed / std::max(elapsed, options.duration);
+            uint64_t p50 = std::min(latency.Percentile(0.5), results.maxLatency.load());
+            uint64_t p99 = std::min(latency.Percentile(0.99), results.maxLatency.load());
+            double cpuPerRequest = completed > 0 ? (double)cpu / (double)completed : 0;
+
+            printf("%-8zu %-16s %12.1f %10s %10s %14.2f %10lu\n", threads, workload.name, throughput,
+                format_ms(p50).c_str(), format_ms(p99).c_str(), cpuPerRequest, errors);
+            fflush(stdout);
+            csv << threads << "," << workload.name << "," << throughput << "," << p50 << "," << p99 << ","
+                << cpuPerRequest << "," << completed << "," << errors << "," << results.connects.load() << "\n";
+        }
+
+        kill(server, SIGINT);
+        int status;
+        waitpid(server, &status, 0);
+    }
+    std::cout << "CSV written to " << options.csv << "\n";
+    return EXIT_SUCCESS;
+}
+
+
+int main(int argc, char** argv) {
+    LoadOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+            }
+            return argv[++i];
+        };
+        if (arg == "--host") {
+            options.host = value();
+        } else if (arg == "--port") {
+            options.port = value();
+        } else if (arg == "--path") {
+            options.path = value();
+        } else if (arg == "--rate") {
+            options.rate = atof(value().c_str());
+        } else if (arg == "--duration") {
+            options.duration = atof(value().c_str());
+        } else if (arg == "--threads") {
+            options.threads = (size_t)atoi(value().c_str());
+        } else if (arg == "--connections") {
+            options.connections = (size_t)atoi(value().c_str());
+        } else if (arg == "--timeout") {
+            options.timeout = atof(value().c_str());
+        } else if (arg == "--close") {
+            options.close = true;
+        } else if (arg == "--sweep") {
+            options.sweep = value();
+        } else if (arg == "--sweep-max") {
+            options.sweepMax = (size_t)atoi(value().c_str());
+        } else if (arg == "--csv") {
+            options.csv = value();
+        } else if (arg == "--replay") {
+            options.replay = value();
+        } else if (arg == "--speed") {
+            options.speed = atof(value().c_str());
+        } else if (arg == "--format") {
+            std::string format = value();
+            if (format != "text" && format != "json") {
+                usage(argv[0]);
+            }
+            options.json = format == "json";
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (!options.replay.empty()) {
+        // a replay takes as long as the capture, its connections come from the capture
+        options.duration = 0;
+        options.connections = options.threads;
+    }
+    if (options.rate < 0 || options.duration < 0 || (options.duration == 0 && options.replay.empty()) || options.threads == 0
+        || options.connections < options.threads || options.sweepMax == 0 || options.speed < 0) {
+        usage(argv[0]);
+    }
+
+    cppserv::LoggerConfig loggerConfig;
+    loggerConfig.file = "logs/cppserv-loadgen.log";
+    cppserv::Logger::init(loggerConfig);
+
+    int status;
+    if (!options.sweep.empty()) {
+        status = run_sweep(options);
+    } else {
+        LoadResults results;
+        double elapsed = options.replay.empty() ? run_load(options, results) : run_replay(options, results);
+        if (elapsed < 0) {
+            cppserv::Logger::Shutdown();
+            return EXIT_FAILURE;
+        }
+        report(options, results, elapsed);
+        status = results.errors.load() + results.timeouts.load() + results.unsent.load() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    cppserv::Logger::Shutdown();
+    return status;
+}
@@ -0,0 +1,296 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <optional>
+#include <cstring>
+#include <ctime>
+#include <arpa/inet.h>
+
+#include "../../src/logger/AccessLogFormat.h"
+#include "../../src/http/httputil.h"
+
+/**
+ * @brief cppserv-logcat decodes binary access log segments written by cppserv to text, JSON or CSV.
+ */
+
+static const char* s_StageNames[cppserv::ACCESS_LOG_STAGES] = { "queue", "first_byte", "read", "handle", "write" };
+
+enum class OutputFormat {
+    TEXT,
+    JSON,
+    CSV
+};
+
+
+/**
+ * @brief Prints the usage of the program and exits with status code EXIT_FAILURE.
+ *
+ * @param program the name of the program
+ */
+void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--format text|json|csv] <segment>...\n";
+    exit(EXIT_FAILURE);
+}
+
+
+/**
+ * @brief Formats the peer address of a record.
+ *
+ * @param record the request record
+ * @return the numeric peer address
+ */
+std::string format_peer(const cppserv::AccessLogRequest& record) {
+    char host[INET6_ADDRSTRLEN] = "-";
+    if (record.peerFamily == AF_INET) {
+        inet_ntop(AF_INET, record.peerAddress, host, sizeof(host));
+    } else if (record.peerFamily == AF_INET6) {
+        inet_ntop(AF_INET6, record.peerAddress, host, sizeof(host));
+    }
+    return host;
+}
+
+
+/**
+ * @brief Formats a nanosecond unix timestamp as ISO 8601 in UTC.
+ *
+ * @param ns the timestamp
+ * @return the formatted timestamp
+ */
+std::string format_time(uint64_t ns) {
+    time_t seconds = (time_t)(ns / 1000000000ull);
+    struct tm tm;
+    gmtime_r(&seconds, &tm);
+    char buffer[64];
+    size_t len = strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &tm);
+    snprintf(buffer + len, sizeof(buffer) - len, ".%06lluZ", (unsigned long long)((ns % 1000000000ull) / 1000));
+    return buffer;
+}
+
+
+/**
+ * @brief Escapes a string for a quoted JSON or CSV field.
+ *
+ * @param value the string
+ * @param format the output format
+ * @return the escaped string, without surrounding quotes
+ */
+std::string escape(const std::string& value, OutputFormat format) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '"') {
+            escaped += format == OutputFormat::CSV ? "\"\"" : "\\\"";
+        } else if (format == OutputFormat::JSON && c == '\\') {
+            escaped += "\\\\";
+        } else if (format == OutputFormat::JSON && (unsigned char)c < 0x20) {
+            char hex[8];
+            snprintf(hex, sizeof(hex), "\\u%04x", c);
+            escaped += hex;
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+
+/**
+ * @brief Finishes a request line with the stage timings and the receive queue time that were logged for it.
+ *
+ * @param timings the timings, nullptr if none were logged
+ * @param format the output format
+ */
+void print_timings(const cppserv::AccessLogTimings* timings, OutputFormat format) {
+    for (uint32_t stage = 0; stage < cppserv::ACCESS_LOG_STAGES; stage++) {
+        uint32_t ns = timings != nullptr ? timings->stageNs[stage] : 0;
+        switch (format) {
+        case OutputFormat::TEXT:
+            if (timings != nullptr) {
+                printf("%s%s=%.1fus", stage == 0 ? " " : ",", s_StageNames[stage], (double)ns / 1e3);
+            }
+            break;
+        case OutputFormat::JSON:
+            if (timings != nullptr) {
+                printf("%s\"%s\":%u", stage == 0 ? ",\"stages_ns\":{" : ",", s_StageNames[stage], ns);
+            }
+            break;
+        case OutputFormat::CSV:
+            if (timings != nullptr) {
+                printf(",%u", ns);
+            } else {
+                printf(",");
+            }
+            break;
+        }
+    }
+    uint32_t receiveQueueNs = timings != nullptr ? timings->receiveQueueNs : 0;
+    switch (format) {
+    case OutputFormat::TEXT:
+        if (receiveQueueNs != 0) {
+            printf(" rx_queue=%.1fus", (double)receiveQueueNs / 1e3);
+        }
+        break;
+    case OutputFormat::JSON:
+        if (timings != nullptr) {
+            printf("}");
+        }
+        if (receiveQueueNs != 0) {
+            printf(",\"rx_queue_ns\":%u", receiveQueueNs);
+        }
+        printf("}");
+        break;
+    case OutputFormat::CSV:
+        if (receiveQueueNs != 0) {
+            printf(",%u", receiveQueueNs);
+        } else {
+            printf(",");
+        }
+        break;
+    }
+    printf("\n");
+}
+
+
+/**
+ * @brief Decodes one segment file and prints its requests.
+ *
+ * @param path the path of the segment
+ * @param format the output format
+ * @return 0 on success, a negative value if the file is not a valid segment
+ */
+int decode_segment(const std::string& path, OutputFormat format) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << path << ": cannot open\n";
+        return -1;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    cppserv::AccessLogFileHeader header;
+    if (data.size() < sizeof(header)) {
+        std::cerr << path << ": truncated header\n";
+        return -1;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (memcmp(header.magic, cppserv::ACCESS_LOG_MAGIC, sizeof(header.magic)) != 0 || header.version != cppserv::ACCESS_LOG_VERSION) {
+        std::cerr << path << ": not a cppserv access log segment (or unsupported version)\n";
+        return -1;
+    }
+
+    std::unordered_map<uint32_t, std::string> strings;
+    std::optional<cppserv::AccessLogTimings> timings;
+    size_t offset = sizeof(header);
+    while (offset + sizeof(cppserv::AccessLogEntryHeader) <= data.size()) {
+        cppserv::AccessLogEntryHeader entry;
+        memcpy(&entry, data.data() + offset, sizeof(entry));
+        if (entry.type == cppserv::ACCESS_LOG_END) {
+            break;
+        }
+        offset += sizeof(entry);
+        if (offset + entry.size > data.size()) {
+            std::cerr << path << ": truncated entry at offset " << offset << "\n";
+            return -1;
+        }
+        const char* payload = data.data() + offset;
+        offset += cppserv::AccessLogPad(entry.size);
+
+        if (entry.type == cppserv::ACCESS_LOG_STRING) {
+            if (entry.size < sizeof(cppserv::AccessLogString)) {
+                continue;
+            }
+            cppserv::AccessLogString string;
+            memcpy(&string, payload, sizeof(string));
+            if (entry.size < sizeof(string) + string.length) {
+                continue;
+            }
+            strings[string.id] = std::string(payload + sizeof(string), string.length);
+            continue;
+        }
+        if (entry.type == cppserv::ACCESS_LOG_TIMINGS && entry.size >= sizeof(cppserv::AccessLogTimings)) {
+            timings.emplace();
+            memcpy(&*timings, payload, sizeof(cppserv::AccessLogTimings));
+            continue;
+        }
+        if (entry.type != cppserv::ACCESS_LOG_REQUEST || entry.size < sizeof(cppserv::AccessLogRequest)) {
+            continue;
+        }
+
+        cppserv::AccessLogRequest record;
+        memcpy(&record, payload, sizeof(record));
+        auto it = strings.find(record.pathId);
+        std::string requestPath = it != strings.end() ? it->second : "-";
+        const char* method = cppserv::HttpMethodToString((cppserv::HttpMethod)record.method);
+        double latencyMs = (double)record.latencyNs / 1e6;
+
+        switch (format) {
+        case OutputFormat::TEXT:
+            printf("%s %s:%u \"%s %s\" %u %u %u %.3fms conn=%llu", format_time(record.timestampNs).c_str(),
+                format_peer(record).c_str(), record.peerPort, method, requestPath.c_str(), record.status,
+                record.bytesIn, record.bytesOut, latencyMs, (unsigned long long)record.connectionId);
+            break;
+        case OutputFormat::JSON:
+            printf("{\"time\":\"%s\",\"peer\":\"%s\",\"port\":%u,\"method\":\"%s\",\"path\":\"%s\",\"status\":%u,"
+                "\"bytes_in\":%u,\"bytes_out\":%u,\"latency_ns\":%llu,\"connection\":%llu,\"worker\":%u",
+                format_time(record.timestampNs).c_str(), format_peer(record).c_str(), record.peerPort, method,
+                escape(requestPath, format).c_str(), record.status, record.bytesIn, record.bytesOut,
+                (unsigned long long)record.latencyNs, (unsigned long long)record.connectionId, header.worker);
+            break;
+        case OutputFormat::CSV:
+            printf("%s,%s,%u,%s,\"%s\",%u,%u,%u,%llu,%llu,%u", format_time(record.timestampNs).c_str(),
+                format_peer(record).c_str(), record.peerPort, method, escape(requestPath, format).c_str(),
+                record.status, record.bytesIn, record.bytesOut, (unsigned long long)record.latencyNs,
+                (unsigned long long)record.connectionId, header.worker);
+            break;
+        }
+        print_timings(timings ? &*timings : nullptr, format);
+        timings.reset();
+    }
+    return 0;
+}
+
+
+int main(int argc, char* argv[]) {
+    OutputFormat format = OutputFormat::TEXT;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--format") {
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+            }
+            std::string value = argv[++i];
+            if (value == "text") {
+                format = OutputFormat::TEXT;
+            } else if (value == "json") {
+                format = OutputFormat::JSON;
+            } else if (value == "csv") {
+                format = OutputFormat::CSV;
+            } else {
+                usage(argv[0]);
+            }
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty()) {
+        usage(argv[0]);
+    }
+
+    if (format == OutputFormat::CSV) {
+        printf("time,peer,port,method,path,status,bytes_in,bytes_out,latency_ns,connection,worker");
+        for (const char* stage : s_StageNames) {
+            printf(",%s_ns", stage);
+        }
+        printf(",rx_queue_ns\n");
+    }
+
+    int status = EXIT_SUCCESS;
+    for (const std::string& file : files) {
+        if (decode_segment(file, format) < 0) {
+            status = EXIT_FAILURE;
+        }
+    }
+    return status;
+}